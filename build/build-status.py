@@ -0,0 +1,8 @@
+#! /usr/bin/env python3
+
+# Programs that are runnable.
+ns3_runnable_programs = ['build/scratch/ns3.33-simulator-main-debug']
+
+# Scripts that are runnable.
+ns3_runnable_scripts = []
+
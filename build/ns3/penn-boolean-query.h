@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_BOOLEAN_QUERY_H
+#define PENN_BOOLEAN_QUERY_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * A SEARCH query with AND, OR, NOT and parentheses, e.g.
+ *   Brad-Pitt AND ( Angelina-Jolie OR Edward-Norton ) NOT Fight-Club
+ * Adjacent operands are ANDed. NOT is a set difference, so it needs a positive
+ * operand in the same AND (a query can't ask for every document not matching).
+ * A term with a '*' is a wildcard, e.g. Brad-*, standing for the OR of the terms it matches.
+ * It needs a prefix before its first '*', the prefix index is searched by that prefix.
+ *
+ * The operator tree compiles to a postfix program of terms and operator tokens. Operands of
+ * AND and OR are ordered by estimated result size, smallest first: the program is run by
+ * visiting the term owners in order and carrying the intermediate results, so the largest
+ * posting lists are consumed where they live and only the small results move.
+ */
+class PennBooleanQuery
+{
+public:
+  // operator tokens of a compiled program, no term can contain a parenthesis
+  static const std::string OP_AND;
+  static const std::string OP_OR;
+  static const std::string OP_DIFF;
+
+  /**
+   *  \returns true if the query tokens use any operator, parenthesis or wildcard
+   */
+  static bool IsBooleanQuery (std::vector<std::string> const &tokens);
+  static bool IsOperator (std::string const &token);
+
+  static bool IsWildcard (std::string const &term);
+  /**
+   *  \returns the part of a wildcard term before its first '*'
+   */
+  static std::string GetWildcardPrefix (std::string const &term);
+  /**
+   *  \returns true if term matches the wildcard pattern, '*' matching any run of characters
+   */
+  static bool MatchesWildcard (std::string const &pattern, std::string const &term);
+
+  /**
+   *  \brief Parses the query tokens, parentheses may be attached to terms
+   *  \returns false with a description in error if the query is malformed
+   */
+  bool Parse (std::vector<std::string> const &tokens, std::string &error);
+
+  void GetTerms (std::set<std::string> &terms) const;
+
+  /**
+   *  \brief Replaces every occurrence of a wildcard term by the OR of the terms it matched
+   *  \param matches the matched terms, if none the wildcard is kept and matches no document
+   */
+  void Expand (std::string const &term, std::set<std::string> const &matches);
+
+  /**
+   *  \brief Compiles the query to a postfix program
+   *  \param listSizes posting list size of the terms, terms missing are taken as large
+   */
+  std::vector<std::string> Compile (std::map<std::string, uint32_t> const &listSizes) const;
+
+  /**
+   *  \brief Applies an operator token to two sorted docID sets
+   */
+  static void Apply (std::string const &op, std::set<std::string> const &left,
+                     std::set<std::string> const &right, std::set<std::string> &result);
+
+private:
+  enum NodeType
+  {
+    TERM,
+    AND,
+    OR,
+    NOT
+  };
+
+  struct Node
+  {
+    NodeType type;
+    std::string term;
+    std::vector<uint32_t> children; // indices into m_nodes
+  };
+
+  uint32_t AddNode (NodeType type, std::string const &term);
+  bool ParseOr (uint32_t &node, std::string &error);
+  bool ParseAnd (uint32_t &node, std::string &error);
+  bool ParseUnary (uint32_t &node, std::string &error);
+  bool Check (uint32_t node, bool negationAllowed, std::string &error) const;
+  uint64_t Compile (uint32_t node, std::map<std::string, uint32_t> const &listSizes,
+                    std::vector<std::string> &program) const;
+
+  std::vector<Node> m_nodes;
+  uint32_t m_root;
+  // tokens being parsed, parentheses split off
+  std::vector<std::string> m_tokens;
+  size_t m_position;
+};
+
+#endif
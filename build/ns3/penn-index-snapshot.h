@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_INDEX_SNAPSHOT_H
+#define PENN_INDEX_SNAPSHOT_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+
+/*
+ * On-disk image of a node's term store, memory-mapped and read in place.
+ *
+ * Layout (host byte order, the file never leaves the node that wrote it):
+ *   header      magic "PENNIDX", format version, term count, doc ref count, string pool size
+ *   dictionary  one entry per term, sorted by term: term (pool offset, length), first doc ref, doc count
+ *   doc refs    the posting blocks, each term's docIDs contiguous and sorted: doc (pool offset, length)
+ *   string pool term and docID bytes, every distinct docID stored once
+ */
+class PennIndexSnapshot
+{
+public:
+  static const uint32_t FORMAT_VERSION = 1;
+
+  PennIndexSnapshot ();
+  ~PennIndexSnapshot ();
+
+  /**
+   *  \brief Writes termStore to fileName, atomically replacing any previous snapshot
+   *
+   *  The file and the rename are both synced, a true return means the snapshot is durable.
+   *  \returns false if the file could not be written
+   */
+  static bool Write (std::string const &fileName, std::map<std::string, std::set<std::string> > const &termStore);
+
+  /**
+   *  \brief Maps fileName read-only, checking the header and that every dictionary entry and doc
+   *  ref stays inside the file
+   *  \returns false if there is no valid snapshot of this format version
+   */
+  bool Open (std::string const &fileName);
+  void Close ();
+  bool IsOpen () const;
+
+  uint32_t GetTermCount () const;
+  std::string GetTerm (uint32_t termIndex) const;
+  void GetPostings (uint32_t termIndex, std::set<std::string> &docIDs) const;
+
+  /**
+   *  \brief Binary search of the mapped dictionary
+   *  \returns index of term, or GetTermCount () if absent
+   */
+  uint32_t Find (std::string const &term) const;
+
+  /**
+   *  \brief Copies the postings of term into docIDs
+   *  \returns false if the snapshot has no such term
+   */
+  bool Lookup (std::string const &term, std::set<std::string> &docIDs) const;
+
+private:
+  struct Header
+  {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t termCount;
+    uint32_t docRefCount;
+    uint32_t poolSize;
+  };
+
+  struct TermEntry
+  {
+    uint32_t termOffset;
+    uint32_t termLength;
+    uint32_t firstDocRef;
+    uint32_t docCount;
+  };
+
+  struct DocRef
+  {
+    uint32_t docOffset;
+    uint32_t docLength;
+  };
+
+  // every entry points inside the doc refs and the string pool
+  bool Validate () const;
+  static bool WriteAll (int fd, const char *data, size_t size);
+
+  const char *m_data;
+  size_t m_size;
+  const Header *m_header;
+  const TermEntry *m_dictionary;
+  const DocRef *m_docRefs;
+  const char *m_pool;
+};
+
+#endif
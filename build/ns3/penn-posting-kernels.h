@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_POSTING_KERNELS_H
+#define PENN_POSTING_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Intersection kernels over posting lists held as sorted arrays of distinct uint32 doc IDs.
+ *
+ * Lists of similar length are merged, four by four with SSE2 where available. When one list is
+ * GALLOP_RATIO times longer than the other, every doc ID of the short list is searched for in the
+ * long one with a galloping (exponential, then binary) search that resumes where the previous one
+ * stopped, which costs O(short * log(long / short)) instead of O(short + long).
+ *
+ * Every kernel writes the intersection, sorted, to out, which must have room for the shorter
+ * list and must not overlap the inputs, and returns its length.
+ */
+class PennPostingKernels
+{
+public:
+  // length ratio from which galloping beats merging
+  static const size_t GALLOP_RATIO = 32;
+
+  static size_t IntersectScalar (const uint32_t *a, size_t aLength, const uint32_t *b, size_t bLength, uint32_t *out);
+  static size_t IntersectMerge (const uint32_t *a, size_t aLength, const uint32_t *b, size_t bLength, uint32_t *out);
+  static size_t IntersectGalloping (const uint32_t *small, size_t smallLength,
+                                    const uint32_t *large, size_t largeLength, uint32_t *out);
+
+  /**
+   *  \brief Picks merging or galloping from the list lengths
+   */
+  static size_t Intersect (const uint32_t *a, size_t aLength, const uint32_t *b, size_t bLength, uint32_t *out);
+  static void Intersect (std::vector<uint32_t> const &a, std::vector<uint32_t> const &b, std::vector<uint32_t> &out);
+
+  /**
+   *  \brief k-way intersection, shortest lists first so the running result only shrinks
+   */
+  static void IntersectMany (std::vector<std::vector<uint32_t> > const &lists, std::vector<uint32_t> &out);
+};
+
+#endif
@@ -0,0 +1,340 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_SEARCH_MESSAGE_H
+#define PENN_SEARCH_MESSAGE_H
+
+#include "ns3/header.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+#define IPV4_ADDRESS_SIZE 4
+
+class PennSearchMessage : public Header
+{
+  public:
+    PennSearchMessage ();
+    virtual ~PennSearchMessage ();
+
+
+    enum MessageType
+      {
+        PING_REQ = 1,
+        PING_RSP = 2,
+        // Define extra message types when needed   
+        // m2
+        INVERTED_MSG = 3,
+        // segment or ack of a message too large for one datagram
+        CHUNK_MSG = 4,
+      };
+
+    PennSearchMessage (PennSearchMessage::MessageType messageType, uint32_t transactionId);
+
+    /**
+    *  \brief Sets message type
+    *  \param messageType message type
+    */
+    void SetMessageType (MessageType messageType);
+
+    /**
+     *  \returns message type
+     */
+    MessageType GetMessageType () const;
+
+    /**
+     *  \brief Sets Transaction Id
+     *  \param transactionId Transaction Id of the request
+     */
+    void SetTransactionId (uint32_t transactionId);
+
+    /**
+     *  \returns Transaction Id
+     */
+    uint32_t GetTransactionId () const;
+
+  private:
+    /**
+     *  \cond
+     */
+    MessageType m_messageType;
+    uint32_t m_transactionId;
+    /**
+     *  \endcond
+     */
+  public:
+    static TypeId GetTypeId (void);
+    virtual TypeId GetInstanceTypeId (void) const;
+    void Print (std::ostream &os) const;
+    uint32_t GetSerializedSize (void) const;
+    void Serialize (Buffer::Iterator start) const;
+    uint32_t Deserialize (Buffer::Iterator start);
+
+    
+    struct PingReq
+      {
+        void Print (std::ostream &os) const;
+        uint32_t GetSerializedSize (void) const;
+        void Serialize (Buffer::Iterator &start) const;
+        uint32_t Deserialize (Buffer::Iterator &start);
+        // Payload
+        std::string pingMessage;
+      };
+
+    struct PingRsp
+      {
+        void Print (std::ostream &os) const;
+        uint32_t GetSerializedSize (void) const;
+        void Serialize (Buffer::Iterator &start) const;
+        uint32_t Deserialize (Buffer::Iterator &start);
+        // Payload
+        std::string pingMessage;
+      };
+
+    // version of a term's posting list on the node that served it
+    struct TermVersion
+    {
+      Ipv4Address holderIp;
+      uint32_t version;
+    };
+
+    // m2
+    struct InvertedMsg
+    {
+      void Print(std::ostream &os) const;
+      uint32_t GetSerializedSize(void) const;
+      void Serialize(Buffer::Iterator &start) const;
+      uint32_t Deserialize(Buffer::Iterator &start);
+
+      // Payload
+      std::string invertedMessage; // subtype, indicate the functionality/purpose of sending this 
+                                    // message: store, search, etc.
+      std::vector<std::string> keywords; // or terms, making it a vec so easier to handle search terms
+      std::set<std::string> docIDs;
+      
+      uint32_t hopCount; // keep track of internal chord hop numbers of this lookup
+      
+      Ipv4Address originatorIp; 
+      Ipv4Address destinationIp;
+
+      // hash keys
+      uint32_t termKey;
+      uint32_t originatorKey;
+      uint32_t destinationKey;
+
+      // store_batch: <term, docIDs> pairs that all belong to destinationIp
+      std::map<std::string, std::set<std::string> > postings;
+      // postings goes on the wire as one docID dictionary plus a compressed posting list of
+      // dictionary indices per term, instead of every docID string under every term
+      bool packedPostings;
+      // the dictionary and the serialized posting list of each term in postings order, packed once
+      // when the postings are set or read, GetSerializedSize and Serialize only copy them out
+      std::vector<std::string> packedDictionary;
+      std::vector<std::vector<uint8_t> > packedLists;
+
+      // search/search_result: the version of every term served so far along the chain
+      // version_probe/version_rsp: the terms to check and the versions found on the holder
+      std::map<std::string, TermVersion> termVersions;
+
+      // bool_eval: the intermediate results of a boolean query, carried from owner to owner
+      std::vector<std::set<std::string> > resultStack;
+
+      // bool_stats_rsp: posting list size of each probed term
+      std::map<std::string, uint32_t> listSizes;
+
+      // merkle_sync/merkle_diff: Merkle tree node index -> hash, all nodes on tree level hopCount
+      // merkle_repair: the leaves whose terms postings replaces
+      std::map<uint32_t, uint64_t> merkleHashes;
+
+      // busy: the subtype an overloaded node turned away, and the milliseconds after which to send it again
+      // busy/retried messages/search_failed: how often the message was turned away so far
+      std::string rejectedMessage;
+      uint32_t retryAfter;
+      uint32_t busyCount;
+
+      // search_result_page: token of the result the page belongs to, the page's index and the
+      // number of pages in the result
+      // search_page_req: token of the result, and the first page the originator is missing
+      uint32_t continuationToken;
+      uint32_t pageIndex;
+      uint32_t pageCount;
+
+      // search_init/search/search_result(_page): the query as the originator caches it, whatever
+      // terms the chain ends up serving
+      std::string queryKey;
+    };
+
+    // one segment ("data") or acknowledgement ("ack") of a chunked transfer
+    struct ChunkMsg
+    {
+      void Print(std::ostream &os) const;
+      uint32_t GetSerializedSize(void) const;
+      void Serialize(Buffer::Iterator &start) const;
+      uint32_t Deserialize(Buffer::Iterator &start);
+
+      // Payload
+      std::string chunkMessage; // subtype: data, ack
+      uint32_t streamId; // unique per sender
+      uint32_t sequenceNumber; // data: index of the segment; ack: every segment below it has arrived
+      uint32_t segmentCount; // data: number of segments in the stream
+      uint32_t window; // ack: segments past sequenceNumber the receiver still accepts
+      std::vector<uint32_t> sackList; // ack: segments received past sequenceNumber
+      std::vector<uint8_t> data; // data: bytes of the segment
+    };
+
+
+  private:
+    struct
+      {
+        PingReq pingReq;
+        PingRsp pingRsp;
+        // m2
+        InvertedMsg invertedMsg;
+        ChunkMsg chunkMsg;
+      } m_message;
+    
+  public:
+    /**
+     *  \returns PingReq Struct
+     */
+    PingReq GetPingReq ();
+
+    /**
+     *  \brief Sets PingReq message params
+     *  \param message Payload String
+     */
+
+    void SetPingReq (std::string message);
+
+    /**
+     * \returns PingRsp Struct
+     */
+    PingRsp GetPingRsp ();
+    /**
+     *  \brief Sets PingRsp message params
+     *  \param message Payload String
+     */
+    void SetPingRsp (std::string message);
+
+    // m2
+    InvertedMsg GetInvertedMessage();
+
+    void SetInvertedMessage(std::string invertedMessage,  std::vector<std::string> keywords, std::set<std::string> docIDs,
+                        uint32_t hopCount, Ipv4Address originatorIp, Ipv4Address destinationIp, uint32_t termKey, 
+                        uint32_t originatorKey, uint32_t destinationKey);
+
+    /**
+     *  \brief Sets the multi-term payload of a store_batch inverted message
+     *  \param postings term to docIDs map
+     */
+    void SetInvertedPostings(std::map<std::string, std::set<std::string> > postings);
+
+    /**
+     *  \brief Sets the postings of an inverted message, compressed on the wire
+     *  \param postings term to docIDs map
+     */
+    void SetInvertedPackedPostings(std::map<std::string, std::set<std::string> > postings);
+
+    /**
+     *  \brief Sets the term versions carried by search and version probe messages
+     *  \param termVersions term to (holder, version) map
+     */
+    void SetInvertedTermVersions(std::map<std::string, TermVersion> termVersions);
+
+    /**
+     *  \brief Sets the evaluation stack of a boolean query step
+     *  \param resultStack intermediate results, top last
+     */
+    void SetInvertedResultStack(std::vector<std::set<std::string> > resultStack);
+
+    /**
+     *  \brief Sets the posting list sizes reported by a term holder
+     *  \param listSizes term to posting list size map
+     */
+    void SetInvertedListSizes(std::map<std::string, uint32_t> listSizes);
+
+    /**
+     *  \brief Sets the Merkle tree nodes exchanged by anti-entropy messages
+     *  \param merkleHashes node index to hash map
+     */
+    void SetInvertedMerkleHashes(std::map<uint32_t, uint64_t> merkleHashes);
+
+    /**
+     *  \brief Turns the message into the busy reply of an overloaded node, everything else is kept
+     *  but the busy count, which goes up by one
+     *  \param retryAfter milliseconds after which the sender may try again
+     */
+    void SetInvertedBusy(uint32_t retryAfter);
+
+    /**
+     *  \brief Turns a busy reply back into the message that was turned away
+     */
+    void SetInvertedRetry();
+
+    /**
+     *  \brief Sets the page of a paged search result a page or a page request is about
+     *  \param continuationToken token of the result
+     *  \param pageIndex index of the page
+     *  \param pageCount pages in the result, 0 in a page request
+     */
+    void SetInvertedContinuationToken(uint32_t continuationToken, uint32_t pageIndex, uint32_t pageCount = 0);
+
+    /**
+     *  \brief Sets the query cache key a search carries to its result
+     *  \param queryKey the originator's cache key of the query
+     */
+    void SetInvertedQueryKey(std::string queryKey);
+
+    /**
+     *  \returns ChunkMsg Struct
+     */
+    ChunkMsg GetChunkMessage ();
+
+    /**
+     *  \brief Sets a data segment of a chunked transfer
+     *  \param streamId id of the stream at the sender
+     *  \param sequenceNumber index of the segment
+     *  \param segmentCount number of segments in the stream
+     *  \param data bytes of the segment
+     */
+    void SetChunkData (uint32_t streamId, uint32_t sequenceNumber, uint32_t segmentCount, std::vector<uint8_t> data);
+
+    /**
+     *  \brief Sets the acknowledgement of a chunked transfer
+     *  \param streamId id of the stream at the sender
+     *  \param cumulativeAck every segment below it has arrived
+     *  \param window segments past cumulativeAck the receiver still accepts
+     *  \param sackList segments received past cumulativeAck
+     */
+    void SetChunkAck (uint32_t streamId, uint32_t cumulativeAck, uint32_t window, std::vector<uint32_t> sackList);
+
+
+}; // class PennSearchMessage
+
+static inline std::ostream& operator<< (std::ostream& os, const PennSearchMessage& message)
+{
+  message.Print (os);
+  return os;
+}
+
+#endif
@@ -0,0 +1,37 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_UPENN_CIS553
+    
+
+// Module headers:
+#include "dv-message.h"
+#include "dv-routing-helper.h"
+#include "dv-routing-protocol.h"
+#include "ls-message.h"
+#include "ls-routing-helper.h"
+#include "ls-routing-protocol.h"
+#include "penn-application.h"
+#include "penn-boolean-query.h"
+#include "penn-chord-message.h"
+#include "penn-chord.h"
+#include "penn-index-snapshot.h"
+#include "penn-key-helper.h"
+#include "penn-log.h"
+#include "penn-merkle-tree.h"
+#include "penn-min-hash.h"
+#include "penn-posting-list.h"
+#include "penn-routing-protocol.h"
+#include "penn-search-helper.h"
+#include "penn-search-message.h"
+#include "penn-search.h"
+#include "penn-term-store.h"
+#include "penn-write-ahead-log.h"
+#include "ping-request.h"
+#include "test-app-helper.h"
+#include "test-app-message.h"
+#include "test-app.h"
+#include "test-result.h"
+#endif
@@ -0,0 +1,453 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-boolean-query.h"
+
+#include <algorithm>
+#include <iterator>
+
+const std::string PennBooleanQuery::OP_AND = "(AND)";
+const std::string PennBooleanQuery::OP_OR = "(OR)";
+const std::string PennBooleanQuery::OP_DIFF = "(DIFF)";
+
+bool
+PennBooleanQuery::IsBooleanQuery (std::vector<std::string> const &tokens)
+{
+  for (auto const &token : tokens)
+    {
+      if (token == "AND" || token == "OR" || token == "NOT" || token.find_first_of ("()*") != std::string::npos)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+PennBooleanQuery::IsOperator (std::string const &token)
+{
+  return token == OP_AND || token == OP_OR || token == OP_DIFF;
+}
+
+bool
+PennBooleanQuery::IsWildcard (std::string const &term)
+{
+  return term.find ('*') != std::string::npos;
+}
+
+std::string
+PennBooleanQuery::GetWildcardPrefix (std::string const &term)
+{
+  return term.substr (0, term.find ('*'));
+}
+
+bool
+PennBooleanQuery::MatchesWildcard (std::string const &pattern, std::string const &term)
+{
+  // greedy glob match, backtracking to the last '*' on a mismatch
+  size_t p = 0;
+  size_t t = 0;
+  size_t starP = std::string::npos;
+  size_t starT = 0;
+  while (t < term.length ())
+    {
+      if (p < pattern.length () && pattern[p] == '*')
+        {
+          starP = p++;
+          starT = t;
+        }
+      else if (p < pattern.length () && pattern[p] == term[t])
+        {
+          ++p;
+          ++t;
+        }
+      else if (starP != std::string::npos)
+        {
+          p = starP + 1;
+          t = ++starT;
+        }
+      else
+        {
+          return false;
+        }
+    }
+  while (p < pattern.length () && pattern[p] == '*')
+    {
+      ++p;
+    }
+  return p == pattern.length ();
+}
+
+bool
+PennBooleanQuery::Parse (std::vector<std::string> const &tokens, std::string &error)
+{
+  m_nodes.clear ();
+  m_tokens.clear ();
+  m_position = 0;
+
+  for (auto const &token : tokens)
+    {
+      size_t begin = 0;
+      for (size_t i = 0; i <= token.length (); ++i)
+        {
+          if (i < token.length () && token[i] != '(' && token[i] != ')')
+            {
+              continue;
+            }
+          if (i > begin)
+            {
+              m_tokens.push_back (token.substr (begin, i - begin));
+            }
+          if (i < token.length ())
+            {
+              m_tokens.push_back (token.substr (i, 1));
+            }
+          begin = i + 1;
+        }
+    }
+
+  if (!ParseOr (m_root, error))
+    {
+      return false;
+    }
+  if (m_position != m_tokens.size ())
+    {
+      error = "unexpected " + m_tokens[m_position];
+      return false;
+    }
+  return Check (m_root, false, error);
+}
+
+void
+PennBooleanQuery::GetTerms (std::set<std::string> &terms) const
+{
+  for (auto const &node : m_nodes)
+    {
+      if (node.type == TERM)
+        {
+          terms.insert (node.term);
+        }
+    }
+}
+
+void
+PennBooleanQuery::Expand (std::string const &term, std::set<std::string> const &matches)
+{
+  if (matches.empty ())
+    {
+      return;
+    }
+
+  for (uint32_t node = 0, nodeCount = m_nodes.size (); node < nodeCount; ++node)
+    {
+      if (m_nodes[node].type != TERM || m_nodes[node].term != term)
+        {
+          continue;
+        }
+      if (matches.size () == 1)
+        {
+          m_nodes[node].term = *matches.begin ();
+          continue;
+        }
+      std::vector<uint32_t> children;
+      for (auto const &match : matches)
+        {
+          children.push_back (AddNode (TERM, match));
+        }
+      // AddNode may have moved m_nodes
+      m_nodes[node].type = OR;
+      m_nodes[node].term.clear ();
+      m_nodes[node].children = children;
+    }
+}
+
+std::vector<std::string>
+PennBooleanQuery::Compile (std::map<std::string, uint32_t> const &listSizes) const
+{
+  std::vector<std::string> program;
+  Compile (m_root, listSizes, program);
+  return program;
+}
+
+void
+PennBooleanQuery::Apply (std::string const &op, std::set<std::string> const &left,
+                         std::set<std::string> const &right, std::set<std::string> &result)
+{
+  result.clear ();
+  if (op == OP_AND)
+    {
+      std::set_intersection (left.begin (), left.end (), right.begin (), right.end (),
+                             std::inserter (result, result.end ()));
+    }
+  else if (op == OP_OR)
+    {
+      std::set_union (left.begin (), left.end (), right.begin (), right.end (),
+                      std::inserter (result, result.end ()));
+    }
+  else if (op == OP_DIFF)
+    {
+      std::set_difference (left.begin (), left.end (), right.begin (), right.end (),
+                           std::inserter (result, result.end ()));
+    }
+}
+
+uint32_t
+PennBooleanQuery::AddNode (NodeType type, std::string const &term)
+{
+  Node node;
+  node.type = type;
+  node.term = term;
+  m_nodes.push_back (node);
+  return m_nodes.size () - 1;
+}
+
+// or := and (OR and)*
+bool
+PennBooleanQuery::ParseOr (uint32_t &node, std::string &error)
+{
+  uint32_t operand;
+  if (!ParseAnd (operand, error))
+    {
+      return false;
+    }
+
+  std::vector<uint32_t> operands (1, operand);
+  while (m_position < m_tokens.size () && m_tokens[m_position] == "OR")
+    {
+      ++m_position;
+      if (!ParseAnd (operand, error))
+        {
+          return false;
+        }
+      operands.push_back (operand);
+    }
+
+  if (operands.size () == 1)
+    {
+      node = operands[0];
+      return true;
+    }
+
+  node = AddNode (OR, "");
+  for (auto child : operands)
+    {
+      // a OR (b OR c) is a OR b OR c
+      std::vector<uint32_t> const &grandChildren = m_nodes[child].children;
+      if (m_nodes[child].type == OR)
+        {
+          m_nodes[node].children.insert (m_nodes[node].children.end (), grandChildren.begin (), grandChildren.end ());
+        }
+      else
+        {
+          m_nodes[node].children.push_back (child);
+        }
+    }
+  return true;
+}
+
+// and := unary ([AND] unary)*
+bool
+PennBooleanQuery::ParseAnd (uint32_t &node, std::string &error)
+{
+  uint32_t operand;
+  if (!ParseUnary (operand, error))
+    {
+      return false;
+    }
+
+  std::vector<uint32_t> operands (1, operand);
+  while (m_position < m_tokens.size () && m_tokens[m_position] != "OR" && m_tokens[m_position] != ")")
+    {
+      if (m_tokens[m_position] == "AND")
+        {
+          ++m_position;
+        }
+      if (!ParseUnary (operand, error))
+        {
+          return false;
+        }
+      operands.push_back (operand);
+    }
+
+  if (operands.size () == 1)
+    {
+      node = operands[0];
+      return true;
+    }
+
+  node = AddNode (AND, "");
+  for (auto child : operands)
+    {
+      std::vector<uint32_t> const &grandChildren = m_nodes[child].children;
+      if (m_nodes[child].type == AND)
+        {
+          m_nodes[node].children.insert (m_nodes[node].children.end (), grandChildren.begin (), grandChildren.end ());
+        }
+      else
+        {
+          m_nodes[node].children.push_back (child);
+        }
+    }
+  return true;
+}
+
+// unary := NOT unary | ( or ) | term
+bool
+PennBooleanQuery::ParseUnary (uint32_t &node, std::string &error)
+{
+  if (m_position == m_tokens.size ())
+    {
+      error = "query ends early";
+      return false;
+    }
+
+  std::string token = m_tokens[m_position++];
+
+  if (token == "NOT")
+    {
+      uint32_t child;
+      if (!ParseUnary (child, error))
+        {
+          return false;
+        }
+      // NOT NOT a is a
+      if (m_nodes[child].type == NOT)
+        {
+          node = m_nodes[child].children[0];
+          return true;
+        }
+      node = AddNode (NOT, "");
+      m_nodes[node].children.push_back (child);
+      return true;
+    }
+
+  if (token == "(")
+    {
+      if (!ParseOr (node, error))
+        {
+          return false;
+        }
+      if (m_position == m_tokens.size () || m_tokens[m_position] != ")")
+        {
+          error = "missing )";
+          return false;
+        }
+      ++m_position;
+      return true;
+    }
+
+  if (token == ")" || token == "AND" || token == "OR")
+    {
+      error = "unexpected " + token;
+      return false;
+    }
+
+  node = AddNode (TERM, token);
+  return true;
+}
+
+// a NOT is only allowed directly under an AND that has a positive operand, and a wildcard
+// only with a prefix: "*" alone would have to visit every node
+bool
+PennBooleanQuery::Check (uint32_t node, bool negationAllowed, std::string &error) const
+{
+  Node const &current = m_nodes[node];
+
+  if (current.type == TERM && IsWildcard (current.term) && GetWildcardPrefix (current.term).empty ())
+    {
+      error = current.term + " needs a prefix before its first *";
+      return false;
+    }
+
+  if (current.type == NOT)
+    {
+      if (!negationAllowed)
+        {
+          error = "NOT needs a positive term ANDed with it";
+          return false;
+        }
+      return Check (current.children[0], false, error);
+    }
+
+  bool hasPositive = false;
+  for (auto child : current.children)
+    {
+      hasPositive = hasPositive || m_nodes[child].type != NOT;
+      if (!Check (child, current.type == AND, error))
+        {
+          return false;
+        }
+    }
+  if (current.type == AND && !hasPositive)
+    {
+      error = "NOT needs a positive term ANDed with it";
+      return false;
+    }
+  return true;
+}
+
+// appends the program of node, returns its estimated result size
+uint64_t
+PennBooleanQuery::Compile (uint32_t node, std::map<std::string, uint32_t> const &listSizes,
+                           std::vector<std::string> &program) const
+{
+  Node const &current = m_nodes[node];
+
+  if (current.type == TERM)
+    {
+      program.push_back (current.term);
+      auto sizeFind = listSizes.find (current.term);
+      return (sizeFind != listSizes.end ()) ? sizeFind->second : UINT32_MAX;
+    }
+
+  // compile every positive operand on its own, then order them by size
+  std::vector<std::pair<uint64_t, std::vector<std::string> > > operands;
+  std::vector<uint32_t> negated;
+  for (auto child : current.children)
+    {
+      if (m_nodes[child].type == NOT)
+        {
+          negated.push_back (m_nodes[child].children[0]);
+          continue;
+        }
+      std::vector<std::string> operandProgram;
+      uint64_t size = Compile (child, listSizes, operandProgram);
+      operands.push_back (std::make_pair (size, operandProgram));
+    }
+  std::stable_sort (operands.begin (), operands.end (),
+                    [] (std::pair<uint64_t, std::vector<std::string> > const &a,
+                        std::pair<uint64_t, std::vector<std::string> > const &b) { return a.first < b.first; });
+
+  std::string const &op = (current.type == AND) ? OP_AND : OP_OR;
+  uint64_t size = (current.type == AND) ? operands[0].first : 0;
+  for (size_t i = 0; i < operands.size (); ++i)
+    {
+      program.insert (program.end (), operands[i].second.begin (), operands[i].second.end ());
+      if (i > 0)
+        {
+          program.push_back (op);
+        }
+      size = (current.type == AND) ? std::min (size, operands[i].first) : size + operands[i].first;
+    }
+
+  // the result so far travels to each negated operand and shrinks there
+  for (auto child : negated)
+    {
+      Compile (child, listSizes, program);
+      program.push_back (OP_DIFF);
+    }
+  return size;
+}
@@ -384,6 +384,12 @@ Ipv4Address PennChord::findSuccIp()
   return succIP;
 }
 
+// 0 until stabilization has given me a pred
+uint32_t PennChord::findPred()
+{
+  return predKey;
+}
+
 void PennChord::processLookupMsg(PennChordMessage message)
 {
   std::string lookupMessage = message.GetLookupMessage().lookupMessage;
@@ -417,7 +423,7 @@ void PennChord::processLookupMsg(PennChordMessage message)
   {
     processFixRespPacket(message);
   }
-  else if (lookupMessage == "search_req")
+  else if (lookupMessage == "search_req" || lookupMessage == "query_req")
   {
     processSearchReqPacket(message);
   }
@@ -832,12 +838,22 @@ void PennChord::printFingerTable()
 }
 
 void PennChord::sendSearchReqPacket(uint32_t searchKey, uint32_t transactionId)
+{
+  sendLookupReqPacket("search_req", searchKey, transactionId);
+}
+
+void PennChord::sendQueryReqPacket(uint32_t searchKey, uint32_t transactionId)
+{
+  sendLookupReqPacket("query_req", searchKey, transactionId);
+}
+
+void PennChord::sendLookupReqPacket(std::string lookupType, uint32_t searchKey, uint32_t transactionId)
 {
   // TODO: handle succIP == uninitialized
   if ((searchKey > myKey && searchKey < succKey) || (myKey > succKey && searchKey < succKey) || (myKey > succKey && searchKey > myKey)) // correct location
   {
-    // the term key belongs to my succ
-    m_searchSuccessCallback(succIP, "search", transactionId);
+    // the term key belongs to my succ, who owns (myKey, succKey)
+    m_searchSuccessCallback(succIP, "search", transactionId, myKey, succKey);
   }
   else
   // send the packet based on finger table
@@ -850,7 +866,7 @@ void PennChord::sendSearchReqPacket(uint32_t searchKey, uint32_t transactionId)
     Ptr<Packet>
         packet = Create<Packet>();
     PennChordMessage message = PennChordMessage(PennChordMessage::LOOKUP_MSG, transactionId);
-    message.SetLookupMessage("search_req", myKey, m_local, searchKey, Ipv4Address(), 0, nextHopAddr);
+    message.SetLookupMessage(lookupType, myKey, m_local, searchKey, Ipv4Address(), 0, nextHopAddr);
     packet->AddHeader(message);
     m_socket->SendTo(packet, 0, InetSocketAddress(nextHopAddr, m_appPort));
   }
@@ -885,6 +901,16 @@ void PennChord::processSearchReqPacket(PennChordMessage searchMessage)
     searchRespPacket->AddHeader(resp);
     m_socket->SendTo(searchRespPacket, 0, InetSocketAddress(originatorIP, m_appPort));
   }
+  else if (searchMessage.GetLookupMessage().lookupMessage == "query_req" && !m_pathCacheFn.IsNull() && m_pathCacheFn(searchKey))
+  // the search layer has the key's posting lists cached, answer as if I were the owner
+  {
+    Ipv4Address originatorIP = searchMessage.GetLookupMessage().originatorIp;
+    Ptr<Packet> searchRespPacket = Create<Packet>();
+    PennChordMessage resp = PennChordMessage(PennChordMessage::LOOKUP_MSG, searchMessage.GetTransactionId());
+    resp.SetLookupMessage("search_resp", myKey, m_local, myKey, m_local, 0, originatorIP);
+    searchRespPacket->AddHeader(resp);
+    m_socket->SendTo(searchRespPacket, 0, InetSocketAddress(originatorIP, m_appPort));
+  }
   else
   // forward the packet to succ
   {
@@ -904,15 +930,23 @@ void PennChord::processSearchResp(PennChordMessage message)
 {
   Ipv4Address resultIp = message.GetLookupMessage().payloadIp;
   uint32_t transactionId = message.GetTransactionId();
-  m_searchSuccessCallback(resultIp, "search", transactionId);
+  // the responder is the owner's pred, so the owner is responsible for (originatorKey, payload]
+  uint32_t rangeStartKey = message.GetLookupMessage().originatorKey;
+  uint32_t ownerKey = message.GetLookupMessage().payload;
+  m_searchSuccessCallback(resultIp, "search", transactionId, rangeStartKey, ownerKey);
 }
 
-void PennChord::SetSearchSuccessCallback(Callback<void, Ipv4Address, std::string, uint32_t> searchSuccessCallback)
+void PennChord::SetSearchSuccessCallback(Callback<void, Ipv4Address, std::string, uint32_t, uint32_t, uint32_t> searchSuccessCallback)
 {
   // this call back function should be the handler implemented in penn-search
   m_searchSuccessCallback = searchSuccessCallback;
 }
 
+void PennChord::SetPathCacheCallback(Callback<bool, uint32_t> pathCacheFn)
+{
+  m_pathCacheFn = pathCacheFn;
+}
+
 // m2b
 void PennChord::SetNodeLeaveCallback(Callback<void, Ipv4Address> nodeLeaveCallback)
 {
@@ -59,7 +59,10 @@ public:
   void SetPingFailureCallback(Callback<void, Ipv4Address, std::string> pingFailureFn);
   void SetPingRecvCallback(Callback<void, Ipv4Address, std::string> pingRecvFn);
   // m2
-  void SetSearchSuccessCallback(Callback<void, Ipv4Address, std::string, uint32_t> searchSuccessCallback);
+  // the last two arguments are the owner's key range (rangeStartKey, ownerKey)
+  void SetSearchSuccessCallback(Callback<void, Ipv4Address, std::string, uint32_t, uint32_t, uint32_t> searchSuccessCallback);
+  // asked on every node a query lookup passes through, returns true to answer the lookup from this node's cache
+  void SetPathCacheCallback(Callback<bool, uint32_t> pathCacheFn);
   // m2b
   void SetNodeJoinCallback(Callback<void, Ipv4Address> nodeJoinCallback);
   void SetNodeLeaveCallback(Callback<void, Ipv4Address> nodeLeaveCallback);
@@ -79,6 +82,7 @@ public:
   // helper functions
   uint32_t findSucc();
   Ipv4Address findSuccIp();
+  uint32_t findPred();
   void printRingStateHelper();
   void forwardingLookupMessage(PennChordMessage lookupMessage, Ipv4Address destination);
   void processLookupMsg(PennChordMessage message);
@@ -117,6 +121,9 @@ public:
   void processSearchReqPacket(PennChordMessage searchMessage);
   void processSearchResp(PennChordMessage message);
   void sendSearchReqPacket(uint32_t searchKey, uint32_t transactionId);
+  // like sendSearchReqPacket, but nodes on the path may answer from their path cache
+  void sendQueryReqPacket(uint32_t searchKey, uint32_t transactionId);
+  void sendLookupReqPacket(std::string lookupType, uint32_t searchKey, uint32_t transactionId);
 
   // 1 <= i <= 32
   void setIthFingerEntery(int i, Ipv4Address addr);
@@ -150,7 +157,8 @@ private:
   Callback<void, Ipv4Address, std::string> m_pingSuccessFn;
   Callback<void, Ipv4Address, std::string> m_pingFailureFn;
   Callback<void, Ipv4Address, std::string> m_pingRecvFn;
-  Callback<void, Ipv4Address, std::string, uint32_t> m_searchSuccessCallback;
+  Callback<void, Ipv4Address, std::string, uint32_t, uint32_t, uint32_t> m_searchSuccessCallback;
+  Callback<bool, uint32_t> m_pathCacheFn;
   // m2b
   Callback<void, Ipv4Address> m_nodeLeaveCallback;
   Callback<void, Ipv4Address> m_nodeJoinCallback;
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-index-snapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char SNAPSHOT_MAGIC[8] = { 'P', 'E', 'N', 'N', 'I', 'D', 'X', 0 };
+
+PennIndexSnapshot::PennIndexSnapshot ()
+  : m_data (NULL),
+    m_size (0),
+    m_header (NULL),
+    m_dictionary (NULL),
+    m_docRefs (NULL),
+    m_pool (NULL)
+{
+}
+
+PennIndexSnapshot::~PennIndexSnapshot ()
+{
+  Close ();
+}
+
+bool
+PennIndexSnapshot::Write (std::string const &fileName, std::map<std::string, std::set<std::string> > const &termStore)
+{
+  std::vector<TermEntry> dictionary;
+  std::vector<DocRef> docRefs;
+  std::string pool;
+  // every distinct docID goes into the pool once
+  std::map<std::string, uint32_t> docOffsets;
+
+  dictionary.reserve (termStore.size ());
+  for (auto const &ent : termStore)
+    {
+      TermEntry termEntry;
+      termEntry.termOffset = pool.size ();
+      termEntry.termLength = ent.first.length ();
+      termEntry.firstDocRef = docRefs.size ();
+      termEntry.docCount = ent.second.size ();
+      pool += ent.first;
+
+      for (auto const &doc : ent.second)
+        {
+          auto offsetFind = docOffsets.find (doc);
+          if (offsetFind == docOffsets.end ())
+            {
+              offsetFind = docOffsets.insert (std::make_pair (doc, (uint32_t) pool.size ())).first;
+              pool += doc;
+            }
+          DocRef docRef = { offsetFind->second, (uint32_t) doc.length () };
+          docRefs.push_back (docRef);
+        }
+
+      dictionary.push_back (termEntry);
+    }
+
+  Header header;
+  memcpy (header.magic, SNAPSHOT_MAGIC, sizeof (header.magic));
+  header.formatVersion = FORMAT_VERSION;
+  header.termCount = dictionary.size ();
+  header.docRefCount = docRefs.size ();
+  header.poolSize = pool.size ();
+
+  // write aside and rename, a reader never maps a half written file
+  std::string tempName = fileName + ".tmp";
+  int fd = open (tempName.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      return false;
+    }
+  bool written = WriteAll (fd, (const char *) &header, sizeof (header))
+                 && WriteAll (fd, (const char *) dictionary.data (), dictionary.size () * sizeof (TermEntry))
+                 && WriteAll (fd, (const char *) docRefs.data (), docRefs.size () * sizeof (DocRef))
+                 && WriteAll (fd, pool.data (), pool.size ());
+  // the data is on disk before the name points at it
+  written = written && fsync (fd) == 0;
+  if (close (fd) != 0 || !written)
+    {
+      remove (tempName.c_str ());
+      return false;
+    }
+
+  if (rename (tempName.c_str (), fileName.c_str ()) != 0)
+    {
+      remove (tempName.c_str ());
+      return false;
+    }
+
+  // and the rename itself, it lives in the directory
+  size_t slash = fileName.rfind ('/');
+  std::string directory = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : fileName.substr (0, slash));
+  int directoryFd = open (directory.c_str (), O_RDONLY);
+  if (directoryFd < 0)
+    {
+      return false;
+    }
+  bool synced = fsync (directoryFd) == 0;
+  close (directoryFd);
+  return synced;
+}
+
+bool
+PennIndexSnapshot::WriteAll (int fd, const char *data, size_t size)
+{
+  while (size > 0)
+    {
+      ssize_t written = write (fd, data, size);
+      if (written < 0)
+        {
+          return false;
+        }
+      data += written;
+      size -= written;
+    }
+  return true;
+}
+
+bool
+PennIndexSnapshot::Open (std::string const &fileName)
+{
+  Close ();
+
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+
+  struct stat fileStat;
+  if (fstat (fd, &fileStat) != 0 || (size_t) fileStat.st_size < sizeof (Header))
+    {
+      close (fd);
+      return false;
+    }
+
+  void *mapped = mmap (NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive, a later snapshot renamed over it doesn't disturb us
+  close (fd);
+  if (mapped == MAP_FAILED)
+    {
+      return false;
+    }
+
+  m_data = (const char *) mapped;
+  m_size = fileStat.st_size;
+  m_header = (const Header *) m_data;
+
+  size_t expectedSize = sizeof (Header) + (size_t) m_header->termCount * sizeof (TermEntry)
+                        + (size_t) m_header->docRefCount * sizeof (DocRef) + m_header->poolSize;
+  if (memcmp (m_header->magic, SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC)) != 0
+      || m_header->formatVersion != FORMAT_VERSION || expectedSize != m_size)
+    {
+      Close ();
+      return false;
+    }
+
+  m_dictionary = (const TermEntry *) (m_data + sizeof (Header));
+  m_docRefs = (const DocRef *) (m_dictionary + m_header->termCount);
+  m_pool = (const char *) (m_docRefs + m_header->docRefCount);
+  if (!Validate ())
+    {
+      Close ();
+      return false;
+    }
+  return true;
+}
+
+bool
+PennIndexSnapshot::Validate () const
+{
+  // 64 bit sums, a corrupt offset near 2^32 must not wrap back into range
+  uint64_t poolSize = m_header->poolSize;
+  for (uint32_t i = 0; i < m_header->termCount; ++i)
+    {
+      const TermEntry &termEntry = m_dictionary[i];
+      if ((uint64_t) termEntry.termOffset + termEntry.termLength > poolSize
+          || (uint64_t) termEntry.firstDocRef + termEntry.docCount > m_header->docRefCount)
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < m_header->docRefCount; ++i)
+    {
+      if ((uint64_t) m_docRefs[i].docOffset + m_docRefs[i].docLength > poolSize)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+PennIndexSnapshot::Close ()
+{
+  if (m_data != NULL)
+    {
+      munmap ((void *) m_data, m_size);
+    }
+  m_data = NULL;
+  m_size = 0;
+  m_header = NULL;
+  m_dictionary = NULL;
+  m_docRefs = NULL;
+  m_pool = NULL;
+}
+
+bool
+PennIndexSnapshot::IsOpen () const
+{
+  return m_data != NULL;
+}
+
+uint32_t
+PennIndexSnapshot::GetTermCount () const
+{
+  return IsOpen () ? m_header->termCount : 0;
+}
+
+std::string
+PennIndexSnapshot::GetTerm (uint32_t termIndex) const
+{
+  const TermEntry &termEntry = m_dictionary[termIndex];
+  return std::string (m_pool + termEntry.termOffset, termEntry.termLength);
+}
+
+void
+PennIndexSnapshot::GetPostings (uint32_t termIndex, std::set<std::string> &docIDs) const
+{
+  const TermEntry &termEntry = m_dictionary[termIndex];
+  const DocRef *docRef = m_docRefs + termEntry.firstDocRef;
+
+  // the block is sorted already, every insert goes to the end
+  for (uint32_t i = 0; i < termEntry.docCount; ++i, ++docRef)
+    {
+      docIDs.insert (docIDs.end (), std::string (m_pool + docRef->docOffset, docRef->docLength));
+    }
+}
+
+uint32_t
+PennIndexSnapshot::Find (std::string const &term) const
+{
+  uint32_t termCount = GetTermCount ();
+  uint32_t low = 0;
+  uint32_t high = termCount;
+
+  // same order as std::string comparison: bytes first, then length
+  while (low < high)
+    {
+      uint32_t middle = low + (high - low) / 2;
+      const TermEntry &termEntry = m_dictionary[middle];
+      size_t commonLength = std::min ((size_t) termEntry.termLength, term.length ());
+      int order = memcmp (m_pool + termEntry.termOffset, term.data (), commonLength);
+      if (order == 0)
+        {
+          order = (termEntry.termLength < term.length ()) ? -1 : (termEntry.termLength > term.length ()) ? 1 : 0;
+        }
+
+      if (order == 0)
+        {
+          return middle;
+        }
+      if (order < 0)
+        {
+          low = middle + 1;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+  return termCount;
+}
+
+bool
+PennIndexSnapshot::Lookup (std::string const &term, std::set<std::string> &docIDs) const
+{
+  uint32_t termIndex = Find (term);
+  if (termIndex == GetTermCount ())
+    {
+      return false;
+    }
+  GetPostings (termIndex, docIDs);
+  return true;
+}
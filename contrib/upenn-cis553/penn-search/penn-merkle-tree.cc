@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-merkle-tree.h"
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t
+FnvAppend (uint64_t hash, const void *data, size_t length)
+{
+  const uint8_t *bytes = (const uint8_t *) data;
+  for (size_t i = 0; i < length; ++i)
+    {
+      hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+  return hash;
+}
+
+PennMerkleTree::PennMerkleTree ()
+  : m_levels (DEPTH + 1),
+    m_built (true)
+{
+}
+
+void
+PennMerkleTree::Clear ()
+{
+  m_levels.assign (DEPTH + 1, std::map<uint32_t, uint64_t> ());
+  m_built = true;
+}
+
+void
+PennMerkleTree::Add (uint32_t key, std::string const &term, std::set<std::string> const &docIDs)
+{
+  // wraps on overflow, a sum of 64 bit hashes stays order independent
+  m_levels[DEPTH][GetLeaf (key)] += HashEntry (term, docIDs);
+  m_built = false;
+}
+
+uint64_t
+PennMerkleTree::GetHash (uint32_t level, uint32_t index)
+{
+  if (!m_built)
+    {
+      Build ();
+    }
+  if (level > DEPTH)
+    {
+      return 0;
+    }
+  auto nodeFind = m_levels[level].find (index);
+  return (nodeFind != m_levels[level].end ()) ? nodeFind->second : 0;
+}
+
+uint32_t
+PennMerkleTree::GetLeaf (uint32_t key)
+{
+  return key >> (32 - FANOUT_BITS * DEPTH);
+}
+
+uint64_t
+PennMerkleTree::HashEntry (std::string const &term, std::set<std::string> const &docIDs)
+{
+  // terms and docIDs never contain a NUL, it separates them
+  uint64_t hash = FnvAppend (FNV_OFFSET, term.data (), term.length () + 1);
+  for (auto const &doc : docIDs)
+    {
+      hash = FnvAppend (hash, doc.c_str (), doc.length () + 1);
+    }
+  // finalize, so that summing entry hashes doesn't cancel low bits out
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+void
+PennMerkleTree::Build ()
+{
+  for (uint32_t level = DEPTH; level > 0; --level)
+    {
+      std::map<uint32_t, uint64_t> &parents = m_levels[level - 1];
+      parents.clear ();
+
+      // children come in index order, so each parent's are contiguous
+      auto childIter = m_levels[level].begin ();
+      while (childIter != m_levels[level].end ())
+        {
+          uint32_t parent = childIter->first >> FANOUT_BITS;
+          uint64_t hash = FNV_OFFSET;
+          for (; childIter != m_levels[level].end () && (childIter->first >> FANOUT_BITS) == parent; ++childIter)
+            {
+              hash = FnvAppend (hash, &childIter->first, sizeof (childIter->first));
+              hash = FnvAppend (hash, &childIter->second, sizeof (childIter->second));
+            }
+          parents[parent] = hash;
+        }
+    }
+  m_built = true;
+}
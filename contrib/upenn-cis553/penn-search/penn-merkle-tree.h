@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_MERKLE_TREE_H
+#define PENN_MERKLE_TREE_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Merkle tree over the 32 bit term key space, used to compare two copies of a key range.
+ *
+ * The tree has a fixed shape so both sides agree on it without exchanging it: level 0 is the
+ * root, every node has FANOUT children, and leaf i on level DEPTH covers the keys whose top
+ * FANOUT_BITS * DEPTH bits are i. A leaf hash is the sum of the hashes of its <term, docIDs>
+ * entries, so entries may be added in any order; a node hash covers its children's hashes.
+ * Empty subtrees hash to 0 and are never stored, the tree costs memory per non-empty leaf only.
+ */
+class PennMerkleTree
+{
+public:
+  static const uint32_t FANOUT_BITS = 4;
+  static const uint32_t FANOUT = 1 << FANOUT_BITS;
+  static const uint32_t DEPTH = 4;
+
+  PennMerkleTree ();
+
+  void Clear ();
+  void Add (uint32_t key, std::string const &term, std::set<std::string> const &docIDs);
+
+  /**
+   *  \returns hash of node index on level, 0 for an empty subtree
+   */
+  uint64_t GetHash (uint32_t level, uint32_t index);
+
+  /**
+   *  \returns index of the leaf covering key
+   */
+  static uint32_t GetLeaf (uint32_t key);
+
+private:
+  static uint64_t HashEntry (std::string const &term, std::set<std::string> const &docIDs);
+  void Build ();
+
+  // non-empty nodes of each level, the leaves last
+  std::vector<std::map<uint32_t, uint64_t> > m_levels;
+  bool m_built;
+};
+
+#endif
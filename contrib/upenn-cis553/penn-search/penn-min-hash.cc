@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-min-hash.h"
+
+#include <cstdio>
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+static const size_t SLOT_DIGITS = 4;
+
+// splitmix64 finalizer, spreads a seeded term hash into an independent looking value
+static uint64_t
+Mix (uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+std::vector<uint32_t>
+PennMinHash::Compute (std::set<std::string> const &terms)
+{
+  std::vector<uint32_t> signature (SIGNATURE_SIZE, UINT32_MAX);
+  for (auto const &term : terms)
+    {
+      uint64_t termHash = FNV_OFFSET;
+      for (unsigned char c : term)
+        {
+          termHash = (termHash ^ c) * FNV_PRIME;
+        }
+      // hash function i is the term hash mixed with seed i
+      for (uint32_t i = 0; i < SIGNATURE_SIZE; ++i)
+        {
+          uint32_t value = Mix (termHash + (i + 1) * 0x9e3779b97f4a7c15ULL);
+          if (value < signature[i])
+            {
+              signature[i] = value;
+            }
+        }
+    }
+  return signature;
+}
+
+std::string
+PennMinHash::GetBucket (std::vector<uint32_t> const &signature, uint32_t band)
+{
+  uint64_t bandHash = FNV_OFFSET;
+  for (uint32_t row = 0; row < ROWS; ++row)
+    {
+      uint32_t value = signature[band * ROWS + row];
+      for (int shift = 0; shift < 32; shift += 8)
+        {
+          bandHash = (bandHash ^ ((value >> shift) & 0xff)) * FNV_PRIME;
+        }
+    }
+  char bucket[32];
+  snprintf (bucket, sizeof (bucket), "%u:%016llx", band, (unsigned long long) bandHash);
+  return bucket;
+}
+
+std::string
+PennMinHash::Encode (std::vector<uint32_t> const &signature)
+{
+  std::string encoded;
+  encoded.reserve (signature.size () * SLOT_DIGITS);
+  char slot[8];
+  for (uint32_t value : signature)
+    {
+      snprintf (slot, sizeof (slot), "%04x", value & 0xffff);
+      encoded += slot;
+    }
+  return encoded;
+}
+
+double
+PennMinHash::EstimateSimilarity (std::string const &encodedA, std::string const &encodedB)
+{
+  if (encodedA.length () != SIGNATURE_SIZE * SLOT_DIGITS || encodedB.length () != encodedA.length ())
+    {
+      return 0;
+    }
+  uint32_t agreeing = 0;
+  for (size_t slot = 0; slot < encodedA.length (); slot += SLOT_DIGITS)
+    {
+      agreeing += encodedA.compare (slot, SLOT_DIGITS, encodedB, slot, SLOT_DIGITS) == 0;
+    }
+  return (double) agreeing / SIGNATURE_SIZE;
+}
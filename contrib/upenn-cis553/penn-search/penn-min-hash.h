@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_MIN_HASH_H
+#define PENN_MIN_HASH_H
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * MinHash signature of a document's term set, and its LSH banding.
+ *
+ * Slot i of the signature is the smallest value of hash function i over the terms, so two
+ * documents agree on a slot with probability equal to the Jaccard similarity of their term sets.
+ * The SIGNATURE_SIZE slots are cut into BANDS bands of ROWS slots; documents agreeing on a whole
+ * band share that band's bucket, which happens for at least one band with probability
+ * 1 - (1 - s^ROWS)^BANDS at similarity s. The shape is fixed so every node buckets alike.
+ */
+class PennMinHash
+{
+public:
+  static const uint32_t BANDS = 8;
+  static const uint32_t ROWS = 4;
+  static const uint32_t SIGNATURE_SIZE = BANDS * ROWS;
+
+  static std::vector<uint32_t> Compute (std::set<std::string> const &terms);
+
+  /**
+   *  \returns the name of the bucket the signature falls into on band
+   */
+  static std::string GetBucket (std::vector<uint32_t> const &signature, uint32_t band);
+
+  /**
+   *  \brief Compact text form of a signature, 16 bits of each slot in hex
+   */
+  static std::string Encode (std::vector<uint32_t> const &signature);
+
+  /**
+   *  \returns the fraction of slots two encoded signatures agree on, an estimate of their
+   *           Jaccard similarity; 0 if either is malformed
+   */
+  static double EstimateSimilarity (std::string const &encodedA, std::string const &encodedB);
+};
+
+#endif
@@ -0,0 +1,550 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-posting-list.h"
+
+#include <algorithm>
+#include <iterator>
+
+static const uint32_t BITMAP_WORDS = 1024;
+
+static void
+WriteU16 (std::vector<uint8_t> &out, uint16_t value)
+{
+  out.push_back (value & 0xff);
+  out.push_back (value >> 8);
+}
+
+static void
+WriteU32 (std::vector<uint8_t> &out, uint32_t value)
+{
+  WriteU16 (out, value & 0xffff);
+  WriteU16 (out, value >> 16);
+}
+
+static uint16_t
+ReadU16 (const uint8_t *data)
+{
+  return data[0] | (data[1] << 8);
+}
+
+static uint32_t
+ReadU32 (const uint8_t *data)
+{
+  return ReadU16 (data) | ((uint32_t) ReadU16 (data + 2) << 16);
+}
+
+PennPostingList::PennPostingList ()
+{
+}
+
+PennPostingList
+PennPostingList::FromSorted (std::vector<uint32_t> const &docIDs)
+{
+  PennPostingList list;
+  size_t i = 0;
+  while (i < docIDs.size ())
+    {
+      Container container;
+      container.key = docIDs[i] >> 16;
+      container.type = ARRAY;
+      for (; i < docIDs.size () && (docIDs[i] >> 16) == container.key; ++i)
+        {
+          container.values.push_back (docIDs[i] & 0xffff);
+        }
+      container.cardinality = container.values.size ();
+      Optimize (container);
+      list.m_containers.push_back (container);
+    }
+  return list;
+}
+
+void
+PennPostingList::Add (uint32_t docID)
+{
+  uint16_t key = docID >> 16;
+  uint16_t low = docID & 0xffff;
+
+  auto containerIter = std::lower_bound (m_containers.begin (), m_containers.end (), key,
+                                         [] (Container const &container, uint16_t k) { return container.key < k; });
+  if (containerIter == m_containers.end () || containerIter->key != key)
+    {
+      Container container;
+      container.key = key;
+      container.type = ARRAY;
+      container.cardinality = 1;
+      container.values.push_back (low);
+      m_containers.insert (containerIter, container);
+      return;
+    }
+
+  Container &container = *containerIter;
+  if (container.type == ARRAY)
+    {
+      auto valueIter = std::lower_bound (container.values.begin (), container.values.end (), low);
+      if (valueIter != container.values.end () && *valueIter == low)
+        {
+          return;
+        }
+      container.values.insert (valueIter, low);
+      ++container.cardinality;
+      if (container.cardinality > ARRAY_MAX_CARDINALITY)
+        {
+          Optimize (container);
+        }
+      return;
+    }
+
+  // a run container takes single adds as a bitmap, Optimize() packs it again
+  if (container.type == RUN)
+    {
+      std::vector<uint64_t> bitmap;
+      ToBitmap (container, bitmap);
+      container.type = BITMAP;
+      container.bitmap.swap (bitmap);
+      container.values.clear ();
+    }
+  uint64_t bit = (uint64_t) 1 << (low & 63);
+  if ((container.bitmap[low >> 6] & bit) == 0)
+    {
+      container.bitmap[low >> 6] |= bit;
+      ++container.cardinality;
+    }
+}
+
+bool
+PennPostingList::Contains (uint32_t docID) const
+{
+  uint16_t key = docID >> 16;
+  uint16_t low = docID & 0xffff;
+
+  auto containerIter = std::lower_bound (m_containers.begin (), m_containers.end (), key,
+                                         [] (Container const &container, uint16_t k) { return container.key < k; });
+  if (containerIter == m_containers.end () || containerIter->key != key)
+    {
+      return false;
+    }
+
+  Container const &container = *containerIter;
+  if (container.type == ARRAY)
+    {
+      return std::binary_search (container.values.begin (), container.values.end (), low);
+    }
+  if (container.type == BITMAP)
+    {
+      return (container.bitmap[low >> 6] >> (low & 63)) & 1;
+    }
+  // the last run starting at or before low
+  for (size_t i = 0; i < container.values.size (); i += 2)
+    {
+      if (container.values[i] > low)
+        {
+          break;
+        }
+      if (low <= container.values[i] + container.values[i + 1])
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint64_t
+PennPostingList::GetCardinality () const
+{
+  uint64_t cardinality = 0;
+  for (auto const &container : m_containers)
+    {
+      cardinality += container.cardinality;
+    }
+  return cardinality;
+}
+
+bool
+PennPostingList::IsEmpty () const
+{
+  return m_containers.empty ();
+}
+
+void
+PennPostingList::ToVector (std::vector<uint32_t> &docIDs) const
+{
+  std::vector<uint16_t> values;
+  for (auto const &container : m_containers)
+    {
+      uint32_t high = (uint32_t) container.key << 16;
+      ToArray (container, values);
+      for (uint16_t low : values)
+        {
+          docIDs.push_back (high | low);
+        }
+    }
+}
+
+PennPostingList
+PennPostingList::And (PennPostingList const &other) const
+{
+  return Combine (OP_AND, other);
+}
+
+PennPostingList
+PennPostingList::Or (PennPostingList const &other) const
+{
+  return Combine (OP_OR, other);
+}
+
+PennPostingList
+PennPostingList::AndNot (PennPostingList const &other) const
+{
+  return Combine (OP_ANDNOT, other);
+}
+
+void
+PennPostingList::Optimize ()
+{
+  for (auto &container : m_containers)
+    {
+      Optimize (container);
+    }
+}
+
+uint32_t
+PennPostingList::GetSerializedSize () const
+{
+  // container count, then per container: key, type, cardinality, payload element count, payload
+  uint32_t size = sizeof (uint32_t);
+  for (auto const &container : m_containers)
+    {
+      size += sizeof (uint16_t) + sizeof (uint8_t) + sizeof (uint32_t) + sizeof (uint32_t);
+      size += (container.type == BITMAP) ? BITMAP_WORDS * sizeof (uint64_t) : container.values.size () * sizeof (uint16_t);
+    }
+  return size;
+}
+
+void
+PennPostingList::Serialize (std::vector<uint8_t> &out) const
+{
+  WriteU32 (out, m_containers.size ());
+  for (auto const &container : m_containers)
+    {
+      WriteU16 (out, container.key);
+      out.push_back (container.type);
+      WriteU32 (out, container.cardinality);
+      if (container.type == BITMAP)
+        {
+          WriteU32 (out, BITMAP_WORDS);
+          for (uint64_t word : container.bitmap)
+            {
+              WriteU32 (out, word & 0xffffffff);
+              WriteU32 (out, word >> 32);
+            }
+          continue;
+        }
+      WriteU32 (out, container.values.size ());
+      for (uint16_t value : container.values)
+        {
+          WriteU16 (out, value);
+        }
+    }
+}
+
+uint32_t
+PennPostingList::Deserialize (const uint8_t *data, uint32_t size)
+{
+  m_containers.clear ();
+  if (size < sizeof (uint32_t))
+    {
+      return 0;
+    }
+  uint32_t containerCount = ReadU32 (data);
+  uint32_t offset = sizeof (uint32_t);
+
+  for (uint32_t i = 0; i < containerCount; ++i)
+    {
+      if (size - offset < 11)
+        {
+          m_containers.clear ();
+          return 0;
+        }
+      Container container;
+      container.key = ReadU16 (data + offset);
+      container.type = data[offset + 2];
+      container.cardinality = ReadU32 (data + offset + 3);
+      uint32_t elementCount = ReadU32 (data + offset + 7);
+      offset += 11;
+
+      uint32_t elementSize = (container.type == BITMAP) ? sizeof (uint64_t) : sizeof (uint16_t);
+      if (container.type > RUN || (container.type == BITMAP && elementCount != BITMAP_WORDS)
+          || (container.type == RUN && elementCount % 2 != 0)
+          || (uint64_t) elementCount * elementSize > size - offset)
+        {
+          m_containers.clear ();
+          return 0;
+        }
+
+      if (container.type == BITMAP)
+        {
+          container.bitmap.resize (BITMAP_WORDS);
+          for (uint32_t j = 0; j < BITMAP_WORDS; ++j, offset += 8)
+            {
+              container.bitmap[j] = ReadU32 (data + offset) | ((uint64_t) ReadU32 (data + offset + 4) << 32);
+            }
+        }
+      else
+        {
+          container.values.resize (elementCount);
+          for (uint32_t j = 0; j < elementCount; ++j, offset += 2)
+            {
+              container.values[j] = ReadU16 (data + offset);
+            }
+          // a run past the end of its chunk would spill into the next one
+          for (uint32_t j = 0; container.type == RUN && j < elementCount; j += 2)
+            {
+              if ((uint32_t) container.values[j] + container.values[j + 1] > 0xffff)
+                {
+                  m_containers.clear ();
+                  return 0;
+                }
+            }
+        }
+      m_containers.push_back (container);
+    }
+  return offset;
+}
+
+void
+PennPostingList::ToBitmap (Container const &container, std::vector<uint64_t> &bitmap)
+{
+  if (container.type == BITMAP)
+    {
+      bitmap = container.bitmap;
+      return;
+    }
+  bitmap.assign (BITMAP_WORDS, 0);
+  if (container.type == ARRAY)
+    {
+      for (uint16_t low : container.values)
+        {
+          bitmap[low >> 6] |= (uint64_t) 1 << (low & 63);
+        }
+      return;
+    }
+  for (size_t i = 0; i < container.values.size (); i += 2)
+    {
+      uint32_t end = (uint32_t) container.values[i] + container.values[i + 1];
+      for (uint32_t low = container.values[i]; low <= end; ++low)
+        {
+          bitmap[low >> 6] |= (uint64_t) 1 << (low & 63);
+        }
+    }
+}
+
+void
+PennPostingList::FromBitmap (uint16_t key, std::vector<uint64_t> const &bitmap, Container &container)
+{
+  container.key = key;
+  container.type = BITMAP;
+  container.bitmap = bitmap;
+  container.values.clear ();
+  container.cardinality = 0;
+  for (uint64_t word : bitmap)
+    {
+      container.cardinality += __builtin_popcountll (word);
+    }
+}
+
+void
+PennPostingList::ToArray (Container const &container, std::vector<uint16_t> &values)
+{
+  values.clear ();
+  if (container.type == ARRAY)
+    {
+      values = container.values;
+      return;
+    }
+  if (container.type == RUN)
+    {
+      for (size_t i = 0; i < container.values.size (); i += 2)
+        {
+          uint32_t end = (uint32_t) container.values[i] + container.values[i + 1];
+          for (uint32_t low = container.values[i]; low <= end; ++low)
+            {
+              values.push_back (low);
+            }
+        }
+      return;
+    }
+  values.reserve (container.cardinality);
+  for (uint32_t word = 0; word < BITMAP_WORDS; ++word)
+    {
+      uint64_t bits = container.bitmap[word];
+      while (bits != 0)
+        {
+          values.push_back (word * 64 + __builtin_ctzll (bits));
+          bits &= bits - 1;
+        }
+    }
+}
+
+void
+PennPostingList::Optimize (Container &container)
+{
+  std::vector<uint16_t> values;
+  ToArray (container, values);
+
+  std::vector<uint16_t> runs;
+  for (size_t i = 0; i < values.size ();)
+    {
+      size_t j = i + 1;
+      while (j < values.size () && values[j] == values[j - 1] + 1)
+        {
+          ++j;
+        }
+      runs.push_back (values[i]);
+      runs.push_back (j - i - 1);
+      i = j;
+    }
+
+  // bytes of each form: 2 per value, 4 per run, 8192 for the bitmap
+  size_t arrayBytes = values.size () * sizeof (uint16_t);
+  size_t runBytes = runs.size () * sizeof (uint16_t);
+  size_t bitmapBytes = BITMAP_WORDS * sizeof (uint64_t);
+
+  container.cardinality = values.size ();
+  if (runBytes < arrayBytes && runBytes < bitmapBytes)
+    {
+      container.type = RUN;
+      container.values.swap (runs);
+      container.bitmap.clear ();
+    }
+  else if (values.size () <= ARRAY_MAX_CARDINALITY)
+    {
+      container.type = ARRAY;
+      container.values.swap (values);
+      container.bitmap.clear ();
+    }
+  else
+    {
+      std::vector<uint64_t> bitmap;
+      ToBitmap (container, bitmap);
+      container.type = BITMAP;
+      container.bitmap.swap (bitmap);
+      container.values.clear ();
+    }
+}
+
+// false if the result is empty
+bool
+PennPostingList::Apply (Operation op, Container const &left, Container const &right, Container &result)
+{
+  result.key = left.key;
+
+  if (left.type == ARRAY && right.type == ARRAY)
+    {
+      std::vector<uint16_t> values;
+      if (op == OP_AND)
+        {
+          std::set_intersection (left.values.begin (), left.values.end (), right.values.begin (), right.values.end (),
+                                 std::back_inserter (values));
+        }
+      else if (op == OP_OR)
+        {
+          std::set_union (left.values.begin (), left.values.end (), right.values.begin (), right.values.end (),
+                          std::back_inserter (values));
+        }
+      else
+        {
+          std::set_difference (left.values.begin (), left.values.end (), right.values.begin (), right.values.end (),
+                               std::back_inserter (values));
+        }
+      result.type = ARRAY;
+      result.values.swap (values);
+      result.cardinality = result.values.size ();
+      result.bitmap.clear ();
+    }
+  else
+    {
+      std::vector<uint64_t> leftBitmap;
+      std::vector<uint64_t> rightBitmap;
+      ToBitmap (left, leftBitmap);
+      ToBitmap (right, rightBitmap);
+      for (uint32_t word = 0; word < BITMAP_WORDS; ++word)
+        {
+          if (op == OP_AND)
+            {
+              leftBitmap[word] &= rightBitmap[word];
+            }
+          else if (op == OP_OR)
+            {
+              leftBitmap[word] |= rightBitmap[word];
+            }
+          else
+            {
+              leftBitmap[word] &= ~rightBitmap[word];
+            }
+        }
+      FromBitmap (left.key, leftBitmap, result);
+    }
+
+  if (result.cardinality == 0)
+    {
+      return false;
+    }
+  Optimize (result);
+  return true;
+}
+
+PennPostingList
+PennPostingList::Combine (Operation op, PennPostingList const &other) const
+{
+  PennPostingList result;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < m_containers.size () || j < other.m_containers.size ())
+    {
+      bool hasLeft = i < m_containers.size ();
+      bool hasRight = j < other.m_containers.size ();
+
+      // a chunk on one side only
+      if (!hasRight || (hasLeft && m_containers[i].key < other.m_containers[j].key))
+        {
+          if (op != OP_AND)
+            {
+              result.m_containers.push_back (m_containers[i]);
+            }
+          ++i;
+          continue;
+        }
+      if (!hasLeft || other.m_containers[j].key < m_containers[i].key)
+        {
+          if (op == OP_OR)
+            {
+              result.m_containers.push_back (other.m_containers[j]);
+            }
+          ++j;
+          continue;
+        }
+
+      Container container;
+      if (Apply (op, m_containers[i], other.m_containers[j], container))
+        {
+          result.m_containers.push_back (container);
+        }
+      ++i;
+      ++j;
+    }
+  return result;
+}
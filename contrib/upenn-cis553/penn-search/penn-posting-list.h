@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_POSTING_LIST_H
+#define PENN_POSTING_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Compressed set of uint32 doc IDs, Roaring style.
+ *
+ * The ID space is cut into chunks of 65536 by the high 16 bits. Each non-empty chunk is a
+ * container of its low 16 bits in whichever form is smallest:
+ *   array   sorted values, for sparse chunks (at most ARRAY_MAX_CARDINALITY)
+ *   bitmap  65536 bits, for dense chunks
+ *   run     sorted (start, length - 1) pairs, for chunks made of a few long runs
+ * AND, OR and ANDNOT work chunk by chunk: two arrays are merged, anything else goes through
+ * 1024-word bitmaps. The serialized form is the containers back to back, little-endian.
+ */
+class PennPostingList
+{
+public:
+  static const uint32_t ARRAY_MAX_CARDINALITY = 4096;
+
+  PennPostingList ();
+
+  /**
+   *  \param docIDs sorted distinct doc IDs
+   */
+  static PennPostingList FromSorted (std::vector<uint32_t> const &docIDs);
+
+  void Add (uint32_t docID);
+  bool Contains (uint32_t docID) const;
+  uint64_t GetCardinality () const;
+  bool IsEmpty () const;
+
+  /**
+   *  \brief Appends the doc IDs in ascending order
+   */
+  void ToVector (std::vector<uint32_t> &docIDs) const;
+
+  PennPostingList And (PennPostingList const &other) const;
+  PennPostingList Or (PennPostingList const &other) const;
+  PennPostingList AndNot (PennPostingList const &other) const;
+
+  /**
+   *  \brief Converts every container to its smallest form
+   */
+  void Optimize ();
+
+  uint32_t GetSerializedSize () const;
+  void Serialize (std::vector<uint8_t> &out) const;
+  /**
+   *  \returns bytes read from data, 0 if data doesn't hold a whole, well-formed posting list
+   */
+  uint32_t Deserialize (const uint8_t *data, uint32_t size);
+
+private:
+  enum ContainerType
+  {
+    ARRAY,
+    BITMAP,
+    RUN
+  };
+
+  struct Container
+  {
+    uint16_t key; // high 16 bits of the chunk
+    uint8_t type;
+    uint32_t cardinality;
+    std::vector<uint16_t> values; // array: values; run: start, length - 1 pairs
+    std::vector<uint64_t> bitmap; // bitmap: 1024 words
+  };
+
+  enum Operation
+  {
+    OP_AND,
+    OP_OR,
+    OP_ANDNOT
+  };
+
+  static void ToBitmap (Container const &container, std::vector<uint64_t> &bitmap);
+  static void FromBitmap (uint16_t key, std::vector<uint64_t> const &bitmap, Container &container);
+  static void ToArray (Container const &container, std::vector<uint16_t> &values);
+  static void Optimize (Container &container);
+  static bool Apply (Operation op, Container const &left, Container const &right, Container &result);
+  PennPostingList Combine (Operation op, PennPostingList const &other) const;
+
+  // sorted by key
+  std::vector<Container> m_containers;
+};
+
+#endif
@@ -16,12 +16,40 @@
 
 #include "ns3/penn-search-message.h"
 #include "ns3/log.h"
+#include "ns3/penn-posting-list.h"
+
+#include <algorithm>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("PennSearchMessage");
 NS_OBJECT_ENSURE_REGISTERED (PennSearchMessage);
 
+// sorted docIDs of all terms, and per term the serialized posting list of its docIDs' positions in there
+static void
+PackPostings(std::map<std::string, std::set<std::string> > const &postings, std::vector<std::string> &dictionary,
+             std::vector<std::vector<uint8_t> > &lists)
+{
+  std::set<std::string> allDocs;
+  for (auto const& ent : postings) {
+    allDocs.insert(ent.second.begin(), ent.second.end());
+  }
+  dictionary.assign(allDocs.begin(), allDocs.end());
+
+  // both sides are sorted, so the positions come out sorted too
+  for (auto const& ent : postings) {
+    std::vector<uint32_t> positions;
+    positions.reserve(ent.second.size());
+    auto dictIter = dictionary.begin();
+    for (auto const& doc : ent.second) {
+      dictIter = std::lower_bound(dictIter, dictionary.end(), doc);
+      positions.push_back(dictIter - dictionary.begin());
+    }
+    lists.push_back(std::vector<uint8_t>());
+    PennPostingList::FromSorted(positions).Serialize(lists.back());
+  }
+}
+
 PennSearchMessage::PennSearchMessage ()
 {
 }
@@ -69,6 +97,9 @@ PennSearchMessage::GetSerializedSize (void) const
       case INVERTED_MSG:
         size += m_message.invertedMsg.GetSerializedSize();
         break; 
+      case CHUNK_MSG:
+        size += m_message.chunkMsg.GetSerializedSize();
+        break;
       default:
         NS_ASSERT (false);
     }
@@ -94,6 +125,9 @@ PennSearchMessage::Print (std::ostream &os) const
       case INVERTED_MSG:
         m_message.invertedMsg.Print(os);
         break;
+      case CHUNK_MSG:
+        m_message.chunkMsg.Print(os);
+        break;
       default:
         break;  
     }
@@ -118,6 +152,9 @@ PennSearchMessage::Serialize (Buffer::Iterator start) const
       case INVERTED_MSG:
         m_message.invertedMsg.Serialize(i);
         break;
+      case CHUNK_MSG:
+        m_message.chunkMsg.Serialize(i);
+        break;
       default:
         NS_ASSERT (false);   
     }
@@ -144,6 +181,9 @@ PennSearchMessage::Deserialize (Buffer::Iterator start)
       case INVERTED_MSG:
         m_message.invertedMsg.Deserialize(i);
         break;
+      case CHUNK_MSG:
+        size += m_message.chunkMsg.Deserialize(i);
+        break;
       default:
         NS_ASSERT (false);
     }
@@ -301,7 +341,7 @@ PennSearchMessage::InvertedMsg::GetSerializedSize(void) const
   size = sizeof(uint16_t) + invertedMessage.length() + 2 * IPV4_ADDRESS_SIZE + 4 * sizeof(uint32_t);
   
   // size of vector
-  size += sizeof(uint16_t);
+  size += sizeof(uint32_t);
   // iterate the vec
   for (std::string term : keywords) {
     // size of term
@@ -311,12 +351,71 @@ PennSearchMessage::InvertedMsg::GetSerializedSize(void) const
   }
 
 
-  size += sizeof(uint16_t);
+  size += sizeof(uint32_t);
   // iterate the set, and add each string's # of chars + actual string
   for (std::string doc : docIDs) {
     size += sizeof(uint16_t);
     size += doc.length();
   }
+
+  // batched postings: # of terms, then per term its string and its docIDs
+  // packed: # of docIDs and the docIDs, then # of terms, then per term its string and posting list
+  size += sizeof(uint8_t);
+  if (packedPostings) {
+    size += sizeof(uint32_t);
+    for (auto const& doc : packedDictionary) {
+      size += sizeof(uint16_t) + doc.length();
+    }
+    size += sizeof(uint32_t);
+    size_t i = 0;
+    for (auto const& ent : postings) {
+      size += sizeof(uint16_t) + ent.first.length();
+      size += sizeof(uint32_t) + packedLists[i++].size();
+    }
+  } else {
+    size += sizeof(uint32_t);
+    for (auto const& ent : postings) {
+      size += sizeof(uint16_t) + ent.first.length();
+      size += sizeof(uint32_t);
+      for (auto const& doc : ent.second) {
+        size += sizeof(uint16_t) + doc.length();
+      }
+    }
+  }
+
+  // term versions: # of terms, then per term its string, holder ip and version
+  size += sizeof(uint32_t);
+  for (auto const& ent : termVersions) {
+    size += sizeof(uint16_t) + ent.first.length() + IPV4_ADDRESS_SIZE + sizeof(uint32_t);
+  }
+
+  // result stack: # of results, then per result its docIDs
+  size += sizeof(uint32_t);
+  for (auto const& result : resultStack) {
+    size += sizeof(uint32_t);
+    for (auto const& doc : result) {
+      size += sizeof(uint16_t) + doc.length();
+    }
+  }
+
+  // list sizes: # of terms, then per term its string and size
+  size += sizeof(uint32_t);
+  for (auto const& ent : listSizes) {
+    size += sizeof(uint16_t) + ent.first.length() + sizeof(uint32_t);
+  }
+
+  // merkle hashes: # of nodes, then per node its index and hash
+  size += sizeof(uint32_t);
+  size += merkleHashes.size() * (sizeof(uint32_t) + sizeof(uint64_t));
+
+  // busy: rejected subtype, retry after, busy count
+  size += sizeof(uint16_t) + rejectedMessage.length() + sizeof(uint32_t) + sizeof(uint32_t);
+
+  // continuation token, page index, page count
+  size += 3 * sizeof(uint32_t);
+
+  // query key
+  size += sizeof(uint16_t) + queryKey.length();
   
   return size;
 }
@@ -334,7 +433,7 @@ void PennSearchMessage::InvertedMsg::Serialize(Buffer::Iterator &start) const
   
 
   // size of keywords
-  start.WriteU16(keywords.size());
+  start.WriteHtonU32(keywords.size());
   // write each term in keywords
   for (std::string term : keywords) {
     start.WriteU16(term.size());
@@ -343,12 +442,91 @@ void PennSearchMessage::InvertedMsg::Serialize(Buffer::Iterator &start) const
   }
 
   // size of set
-  start.WriteU16(docIDs.size());
+  start.WriteHtonU32(docIDs.size());
   // write each docIdstring in docIds set
   for (std::string doc : docIDs) {
     start.WriteU16(doc.length());
     start.Write((uint8_t *)(const_cast<char *>(doc.c_str())), doc.length());
   }
+
+  // batched postings
+  start.WriteU8(packedPostings);
+  if (packedPostings) {
+    start.WriteHtonU32(packedDictionary.size());
+    for (auto const& doc : packedDictionary) {
+      start.WriteU16(doc.length());
+      start.Write((uint8_t *)(const_cast<char *>(doc.c_str())), doc.length());
+    }
+    start.WriteHtonU32(postings.size());
+    size_t i = 0;
+    for (auto const& ent : postings) {
+      start.WriteU16(ent.first.length());
+      start.Write((uint8_t *)(const_cast<char *>(ent.first.c_str())), ent.first.length());
+      std::vector<uint8_t> const &bytes = packedLists[i++];
+      start.WriteHtonU32(bytes.size());
+      start.Write(bytes.data(), bytes.size());
+    }
+  } else {
+    start.WriteHtonU32(postings.size());
+    for (auto const& ent : postings) {
+      start.WriteU16(ent.first.length());
+      start.Write((uint8_t *)(const_cast<char *>(ent.first.c_str())), ent.first.length());
+      start.WriteHtonU32(ent.second.size());
+      for (auto const& doc : ent.second) {
+        start.WriteU16(doc.length());
+        start.Write((uint8_t *)(const_cast<char *>(doc.c_str())), doc.length());
+      }
+    }
+  }
+
+  // term versions
+  start.WriteHtonU32(termVersions.size());
+  for (auto const& ent : termVersions) {
+    start.WriteU16(ent.first.length());
+    start.Write((uint8_t *)(const_cast<char *>(ent.first.c_str())), ent.first.length());
+    start.WriteHtonU32(ent.second.holderIp.Get());
+    start.WriteHtonU32(ent.second.version);
+  }
+
+  // result stack
+  start.WriteHtonU32(resultStack.size());
+  for (auto const& result : resultStack) {
+    start.WriteHtonU32(result.size());
+    for (auto const& doc : result) {
+      start.WriteU16(doc.length());
+      start.Write((uint8_t *)(const_cast<char *>(doc.c_str())), doc.length());
+    }
+  }
+
+  // list sizes
+  start.WriteHtonU32(listSizes.size());
+  for (auto const& ent : listSizes) {
+    start.WriteU16(ent.first.length());
+    start.Write((uint8_t *)(const_cast<char *>(ent.first.c_str())), ent.first.length());
+    start.WriteHtonU32(ent.second);
+  }
+
+  // merkle hashes
+  start.WriteHtonU32(merkleHashes.size());
+  for (auto const& ent : merkleHashes) {
+    start.WriteHtonU32(ent.first);
+    start.WriteHtonU64(ent.second);
+  }
+
+  // busy
+  start.WriteU16(rejectedMessage.length());
+  start.Write((uint8_t *)(const_cast<char *>(rejectedMessage.c_str())), rejectedMessage.length());
+  start.WriteHtonU32(retryAfter);
+  start.WriteHtonU32(busyCount);
+
+  // continuation token
+  start.WriteHtonU32(continuationToken);
+  start.WriteHtonU32(pageIndex);
+  start.WriteHtonU32(pageCount);
+
+  // query key
+  start.WriteU16(queryKey.length());
+  start.Write((uint8_t *)(const_cast<char *>(queryKey.c_str())), queryKey.length());
   
   // write others
   start.WriteHtonU32(hopCount);
@@ -371,7 +549,7 @@ PennSearchMessage::InvertedMsg::Deserialize(Buffer::Iterator &start)
   free(str);
 
   // keywords
-  uint16_t vcecSize = start.ReadU16();
+  uint32_t vcecSize = start.ReadNtohU32();
 
   for (size_t i = 0; i < vcecSize; ++i) {
     length = start.ReadU16();
@@ -385,7 +563,7 @@ PennSearchMessage::InvertedMsg::Deserialize(Buffer::Iterator &start)
 
 
   // size of the docIDs set
-  uint16_t setSize = start.ReadU16();
+  uint32_t setSize = start.ReadNtohU32();
   // iterate each docId
   for (size_t i = 0; i < setSize; ++i) {
     // length
@@ -397,6 +575,131 @@ PennSearchMessage::InvertedMsg::Deserialize(Buffer::Iterator &start)
     free(str);
   }
 
+  // batched postings
+  packedPostings = start.ReadU8();
+  packedLists.clear();
+  std::vector<std::string> dictionary;
+  if (packedPostings) {
+    uint32_t dictionarySize = start.ReadNtohU32();
+    dictionary.reserve(dictionarySize);
+    for (size_t i = 0; i < dictionarySize; ++i) {
+      length = start.ReadU16();
+      char *docStr = (char *)malloc(length);
+      start.Read((uint8_t *)docStr, length);
+      dictionary.push_back(std::string(docStr, length));
+      free(docStr);
+    }
+  }
+  uint32_t termCount = start.ReadNtohU32();
+  for (size_t i = 0; i < termCount; ++i) {
+    length = start.ReadU16();
+    char *termStr = (char *)malloc(length);
+    start.Read((uint8_t *)termStr, length);
+    std::set<std::string> &termDocs = postings[std::string(termStr, length)];
+    free(termStr);
+
+    if (packedPostings) {
+      uint32_t byteCount = start.ReadNtohU32();
+      std::vector<uint8_t> bytes(byteCount);
+      start.Read(bytes.data(), byteCount);
+      PennPostingList list;
+      std::vector<uint32_t> positions;
+      if (list.Deserialize(bytes.data(), byteCount) == byteCount) {
+        list.ToVector(positions);
+      }
+      for (uint32_t position : positions) {
+        if (position < dictionary.size()) {
+          termDocs.insert(termDocs.end(), dictionary[position]);
+        }
+      }
+      packedLists.push_back(bytes);
+      continue;
+    }
+
+    uint32_t docCount = start.ReadNtohU32();
+    for (size_t j = 0; j < docCount; ++j) {
+      length = start.ReadU16();
+      char *docStr = (char *)malloc(length);
+      start.Read((uint8_t *)docStr, length);
+      termDocs.insert(std::string(docStr, length));
+      free(docStr);
+    }
+  }
+  // kept as read for a message sent on as it came, packed again if a term came twice
+  if (packedPostings) {
+    packedDictionary.swap(dictionary);
+    if (packedLists.size() != postings.size()) {
+      packedDictionary.clear();
+      packedLists.clear();
+      PackPostings(postings, packedDictionary, packedLists);
+    }
+  }
+
+  // term versions
+  uint32_t versionCount = start.ReadNtohU32();
+  for (size_t i = 0; i < versionCount; ++i) {
+    length = start.ReadU16();
+    char *termStr = (char *)malloc(length);
+    start.Read((uint8_t *)termStr, length);
+    TermVersion &termVersion = termVersions[std::string(termStr, length)];
+    free(termStr);
+
+    termVersion.holderIp = Ipv4Address(start.ReadNtohU32());
+    termVersion.version = start.ReadNtohU32();
+  }
+
+  // result stack
+  uint32_t resultCount = start.ReadNtohU32();
+  resultStack.resize(resultCount);
+  for (size_t i = 0; i < resultCount; ++i) {
+    uint32_t docCount = start.ReadNtohU32();
+    for (size_t j = 0; j < docCount; ++j) {
+      length = start.ReadU16();
+      char *docStr = (char *)malloc(length);
+      start.Read((uint8_t *)docStr, length);
+      resultStack[i].insert(resultStack[i].end(), std::string(docStr, length));
+      free(docStr);
+    }
+  }
+
+  // list sizes
+  uint32_t sizeCount = start.ReadNtohU32();
+  for (size_t i = 0; i < sizeCount; ++i) {
+    length = start.ReadU16();
+    char *termStr = (char *)malloc(length);
+    start.Read((uint8_t *)termStr, length);
+    listSizes[std::string(termStr, length)] = start.ReadNtohU32();
+    free(termStr);
+  }
+
+  // merkle hashes
+  uint32_t nodeCount = start.ReadNtohU32();
+  for (size_t i = 0; i < nodeCount; ++i) {
+    uint32_t nodeIndex = start.ReadNtohU32();
+    merkleHashes[nodeIndex] = start.ReadNtohU64();
+  }
+
+  // busy
+  length = start.ReadU16();
+  char *rejectedStr = (char *)malloc(length);
+  start.Read((uint8_t *)rejectedStr, length);
+  rejectedMessage = std::string(rejectedStr, length);
+  free(rejectedStr);
+  retryAfter = start.ReadNtohU32();
+  busyCount = start.ReadNtohU32();
+
+  // continuation token
+  continuationToken = start.ReadNtohU32();
+  pageIndex = start.ReadNtohU32();
+  pageCount = start.ReadNtohU32();
+
+  // query key
+  length = start.ReadU16();
+  char *queryKeyStr = (char *)malloc(length);
+  start.Read((uint8_t *)queryKeyStr, length);
+  queryKey = std::string(queryKeyStr, length);
+  free(queryKeyStr);
+
   // others
   hopCount = start.ReadNtohU32();
   originatorIp = Ipv4Address(start.ReadNtohU32());
@@ -409,6 +712,120 @@ PennSearchMessage::InvertedMsg::Deserialize(Buffer::Iterator &start)
 }
 /* end of Inverted Msg */
 
+/* CHUNK_MSG */
+
+uint32_t
+PennSearchMessage::ChunkMsg::GetSerializedSize(void) const
+{
+  uint32_t size;
+  size = sizeof(uint16_t) + chunkMessage.length() + 4 * sizeof(uint32_t);
+  size += sizeof(uint32_t) + sackList.size() * sizeof(uint32_t);
+  size += sizeof(uint32_t) + data.size();
+  return size;
+}
+
+void
+PennSearchMessage::ChunkMsg::Print(std::ostream &os) const
+{
+  os << "ChunkMsg:: Message: " << chunkMessage << " stream: " << streamId << " seq: " << sequenceNumber << "\n";
+}
+
+void
+PennSearchMessage::ChunkMsg::Serialize(Buffer::Iterator &start) const
+{
+  start.WriteU16(chunkMessage.length());
+  start.Write((uint8_t *)(const_cast<char *>(chunkMessage.c_str())), chunkMessage.length());
+
+  start.WriteHtonU32(streamId);
+  start.WriteHtonU32(sequenceNumber);
+  start.WriteHtonU32(segmentCount);
+  start.WriteHtonU32(window);
+
+  start.WriteHtonU32(sackList.size());
+  for (uint32_t sequence : sackList) {
+    start.WriteHtonU32(sequence);
+  }
+
+  start.WriteHtonU32(data.size());
+  if (!data.empty()) {
+    start.Write(&data[0], data.size());
+  }
+}
+
+uint32_t
+PennSearchMessage::ChunkMsg::Deserialize(Buffer::Iterator &start)
+{
+  uint16_t length = start.ReadU16();
+  char *str = (char *)malloc(length);
+  start.Read((uint8_t *)str, length);
+  chunkMessage = std::string(str, length);
+  free(str);
+
+  streamId = start.ReadNtohU32();
+  sequenceNumber = start.ReadNtohU32();
+  segmentCount = start.ReadNtohU32();
+  window = start.ReadNtohU32();
+
+  uint32_t sackCount = start.ReadNtohU32();
+  for (uint32_t i = 0; i < sackCount; ++i) {
+    sackList.push_back(start.ReadNtohU32());
+  }
+
+  uint32_t dataLength = start.ReadNtohU32();
+  data.resize(dataLength);
+  if (dataLength > 0) {
+    start.Read(&data[0], dataLength);
+  }
+
+  return ChunkMsg::GetSerializedSize();
+}
+
+PennSearchMessage::ChunkMsg
+PennSearchMessage::GetChunkMessage()
+{
+  return m_message.chunkMsg;
+}
+
+void
+PennSearchMessage::SetChunkData(uint32_t streamId, uint32_t sequenceNumber, uint32_t segmentCount, std::vector<uint8_t> data)
+{
+  if (m_messageType == 0)
+    {
+      m_messageType = CHUNK_MSG;
+    }
+  else
+    {
+      NS_ASSERT(m_messageType == CHUNK_MSG);
+    }
+  m_message.chunkMsg.chunkMessage = "data";
+  m_message.chunkMsg.streamId = streamId;
+  m_message.chunkMsg.sequenceNumber = sequenceNumber;
+  m_message.chunkMsg.segmentCount = segmentCount;
+  m_message.chunkMsg.window = 0;
+  m_message.chunkMsg.sackList.clear();
+  m_message.chunkMsg.data = data;
+}
+
+void
+PennSearchMessage::SetChunkAck(uint32_t streamId, uint32_t cumulativeAck, uint32_t window, std::vector<uint32_t> sackList)
+{
+  if (m_messageType == 0)
+    {
+      m_messageType = CHUNK_MSG;
+    }
+  else
+    {
+      NS_ASSERT(m_messageType == CHUNK_MSG);
+    }
+  m_message.chunkMsg.chunkMessage = "ack";
+  m_message.chunkMsg.streamId = streamId;
+  m_message.chunkMsg.sequenceNumber = cumulativeAck;
+  m_message.chunkMsg.segmentCount = 0;
+  m_message.chunkMsg.window = window;
+  m_message.chunkMsg.sackList = sackList;
+  m_message.chunkMsg.data.clear();
+}
+
 /* */
 
 // getter and setter for inverted message //
@@ -447,7 +864,92 @@ void PennSearchMessage::SetInvertedMessage(std::string invertedMessage, std::vec
 
   m_message.invertedMsg.destinationKey = destinationKey;
 
+  m_message.invertedMsg.retryAfter = 0;
+
+  m_message.invertedMsg.busyCount = 0;
+
+  m_message.invertedMsg.continuationToken = 0;
+
+  m_message.invertedMsg.pageIndex = 0;
+
+  m_message.invertedMsg.pageCount = 0;
+
+  m_message.invertedMsg.packedPostings = false;
+
+}
+
+void PennSearchMessage::SetInvertedPostings(std::map<std::string, std::set<std::string> > postings) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.postings = postings;
+  m_message.invertedMsg.packedPostings = false;
+  m_message.invertedMsg.packedDictionary.clear();
+  m_message.invertedMsg.packedLists.clear();
+}
+
+void PennSearchMessage::SetInvertedPackedPostings(std::map<std::string, std::set<std::string> > postings) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.postings = postings;
+  m_message.invertedMsg.packedPostings = true;
+  m_message.invertedMsg.packedDictionary.clear();
+  m_message.invertedMsg.packedLists.clear();
+  PackPostings(m_message.invertedMsg.postings, m_message.invertedMsg.packedDictionary, m_message.invertedMsg.packedLists);
+}
+
+void PennSearchMessage::SetInvertedTermVersions(std::map<std::string, TermVersion> termVersions) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.termVersions = termVersions;
+}
+
+void PennSearchMessage::SetInvertedResultStack(std::vector<std::set<std::string> > resultStack) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.resultStack = resultStack;
+}
+
+void PennSearchMessage::SetInvertedListSizes(std::map<std::string, uint32_t> listSizes) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.listSizes = listSizes;
+}
+
+void PennSearchMessage::SetInvertedMerkleHashes(std::map<uint32_t, uint64_t> merkleHashes) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.merkleHashes = merkleHashes;
+}
+
+void PennSearchMessage::SetInvertedBusy(uint32_t retryAfter) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.rejectedMessage = m_message.invertedMsg.invertedMessage;
+  m_message.invertedMsg.invertedMessage = "busy";
+  m_message.invertedMsg.retryAfter = retryAfter;
+  ++m_message.invertedMsg.busyCount;
+}
+
+void PennSearchMessage::SetInvertedRetry() {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.invertedMessage = m_message.invertedMsg.rejectedMessage;
+  m_message.invertedMsg.rejectedMessage = "";
+  m_message.invertedMsg.retryAfter = 0;
+}
+
+void PennSearchMessage::SetInvertedContinuationToken(uint32_t continuationToken, uint32_t pageIndex, uint32_t pageCount) {
+
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.continuationToken = continuationToken;
+  m_message.invertedMsg.pageIndex = pageIndex;
+  m_message.invertedMsg.pageCount = pageCount;
+}
+
+void PennSearchMessage::SetInvertedQueryKey(std::string queryKey) {
 
+  NS_ASSERT(m_messageType == INVERTED_MSG);
+  m_message.invertedMsg.queryKey = queryKey;
 }
 
 /* */
@@ -23,7 +23,9 @@
 #include "ns3/object.h"
 
 #include <unordered_map>
+#include <map>
 #include <set>
+#include <vector>
 
 using namespace ns3;
 
@@ -43,6 +45,8 @@ class PennSearchMessage : public Header
         // Define extra message types when needed   
         // m2
         INVERTED_MSG = 3,
+        // segment or ack of a message too large for one datagram
+        CHUNK_MSG = 4,
       };
 
     PennSearchMessage (PennSearchMessage::MessageType messageType, uint32_t transactionId);
@@ -107,6 +111,13 @@ class PennSearchMessage : public Header
         std::string pingMessage;
       };
 
+    // version of a term's posting list on the node that served it
+    struct TermVersion
+    {
+      Ipv4Address holderIp;
+      uint32_t version;
+    };
+
     // m2
     struct InvertedMsg
     {
@@ -130,6 +141,65 @@ class PennSearchMessage : public Header
       uint32_t termKey;
       uint32_t originatorKey;
       uint32_t destinationKey;
+
+      // store_batch: <term, docIDs> pairs that all belong to destinationIp
+      std::map<std::string, std::set<std::string> > postings;
+      // postings goes on the wire as one docID dictionary plus a compressed posting list of
+      // dictionary indices per term, instead of every docID string under every term
+      bool packedPostings;
+      // the dictionary and the serialized posting list of each term in postings order, packed once
+      // when the postings are set or read, GetSerializedSize and Serialize only copy them out
+      std::vector<std::string> packedDictionary;
+      std::vector<std::vector<uint8_t> > packedLists;
+
+      // search/search_result: the version of every term served so far along the chain
+      // version_probe/version_rsp: the terms to check and the versions found on the holder
+      std::map<std::string, TermVersion> termVersions;
+
+      // bool_eval: the intermediate results of a boolean query, carried from owner to owner
+      std::vector<std::set<std::string> > resultStack;
+
+      // bool_stats_rsp: posting list size of each probed term
+      std::map<std::string, uint32_t> listSizes;
+
+      // merkle_sync/merkle_diff: Merkle tree node index -> hash, all nodes on tree level hopCount
+      // merkle_repair: the leaves whose terms postings replaces
+      std::map<uint32_t, uint64_t> merkleHashes;
+
+      // busy: the subtype an overloaded node turned away, and the milliseconds after which to send it again
+      // busy/retried messages/search_failed: how often the message was turned away so far
+      std::string rejectedMessage;
+      uint32_t retryAfter;
+      uint32_t busyCount;
+
+      // search_result_page: token of the result the page belongs to, the page's index and the
+      // number of pages in the result
+      // search_page_req: token of the result, and the first page the originator is missing
+      uint32_t continuationToken;
+      uint32_t pageIndex;
+      uint32_t pageCount;
+
+      // search_init/search/search_result(_page): the query as the originator caches it, whatever
+      // terms the chain ends up serving
+      std::string queryKey;
+    };
+
+    // one segment ("data") or acknowledgement ("ack") of a chunked transfer
+    struct ChunkMsg
+    {
+      void Print(std::ostream &os) const;
+      uint32_t GetSerializedSize(void) const;
+      void Serialize(Buffer::Iterator &start) const;
+      uint32_t Deserialize(Buffer::Iterator &start);
+
+      // Payload
+      std::string chunkMessage; // subtype: data, ack
+      uint32_t streamId; // unique per sender
+      uint32_t sequenceNumber; // data: index of the segment; ack: every segment below it has arrived
+      uint32_t segmentCount; // data: number of segments in the stream
+      uint32_t window; // ack: segments past sequenceNumber the receiver still accepts
+      std::vector<uint32_t> sackList; // ack: segments received past sequenceNumber
+      std::vector<uint8_t> data; // data: bytes of the segment
     };
 
 
@@ -140,6 +210,7 @@ class PennSearchMessage : public Header
         PingRsp pingRsp;
         // m2
         InvertedMsg invertedMsg;
+        ChunkMsg chunkMsg;
       } m_message;
     
   public:
@@ -172,6 +243,91 @@ class PennSearchMessage : public Header
                         uint32_t hopCount, Ipv4Address originatorIp, Ipv4Address destinationIp, uint32_t termKey, 
                         uint32_t originatorKey, uint32_t destinationKey);
 
+    /**
+     *  \brief Sets the multi-term payload of a store_batch inverted message
+     *  \param postings term to docIDs map
+     */
+    void SetInvertedPostings(std::map<std::string, std::set<std::string> > postings);
+
+    /**
+     *  \brief Sets the postings of an inverted message, compressed on the wire
+     *  \param postings term to docIDs map
+     */
+    void SetInvertedPackedPostings(std::map<std::string, std::set<std::string> > postings);
+
+    /**
+     *  \brief Sets the term versions carried by search and version probe messages
+     *  \param termVersions term to (holder, version) map
+     */
+    void SetInvertedTermVersions(std::map<std::string, TermVersion> termVersions);
+
+    /**
+     *  \brief Sets the evaluation stack of a boolean query step
+     *  \param resultStack intermediate results, top last
+     */
+    void SetInvertedResultStack(std::vector<std::set<std::string> > resultStack);
+
+    /**
+     *  \brief Sets the posting list sizes reported by a term holder
+     *  \param listSizes term to posting list size map
+     */
+    void SetInvertedListSizes(std::map<std::string, uint32_t> listSizes);
+
+    /**
+     *  \brief Sets the Merkle tree nodes exchanged by anti-entropy messages
+     *  \param merkleHashes node index to hash map
+     */
+    void SetInvertedMerkleHashes(std::map<uint32_t, uint64_t> merkleHashes);
+
+    /**
+     *  \brief Turns the message into the busy reply of an overloaded node, everything else is kept
+     *  but the busy count, which goes up by one
+     *  \param retryAfter milliseconds after which the sender may try again
+     */
+    void SetInvertedBusy(uint32_t retryAfter);
+
+    /**
+     *  \brief Turns a busy reply back into the message that was turned away
+     */
+    void SetInvertedRetry();
+
+    /**
+     *  \brief Sets the page of a paged search result a page or a page request is about
+     *  \param continuationToken token of the result
+     *  \param pageIndex index of the page
+     *  \param pageCount pages in the result, 0 in a page request
+     */
+    void SetInvertedContinuationToken(uint32_t continuationToken, uint32_t pageIndex, uint32_t pageCount = 0);
+
+    /**
+     *  \brief Sets the query cache key a search carries to its result
+     *  \param queryKey the originator's cache key of the query
+     */
+    void SetInvertedQueryKey(std::string queryKey);
+
+    /**
+     *  \returns ChunkMsg Struct
+     */
+    ChunkMsg GetChunkMessage ();
+
+    /**
+     *  \brief Sets a data segment of a chunked transfer
+     *  \param streamId id of the stream at the sender
+     *  \param sequenceNumber index of the segment
+     *  \param segmentCount number of segments in the stream
+     *  \param data bytes of the segment
+     */
+    void SetChunkData (uint32_t streamId, uint32_t sequenceNumber, uint32_t segmentCount, std::vector<uint8_t> data);
+
+    /**
+     *  \brief Sets the acknowledgement of a chunked transfer
+     *  \param streamId id of the stream at the sender
+     *  \param cumulativeAck every segment below it has arrived
+     *  \param window segments past cumulativeAck the receiver still accepts
+     *  \param sackList segments received past cumulativeAck
+     */
+    void SetChunkAck (uint32_t streamId, uint32_t cumulativeAck, uint32_t window, std::vector<uint32_t> sackList);
+
 
 }; // class PennSearchMessage
 
@@ -22,6 +22,12 @@
 #include "ns3/penn-application.h"
 #include "ns3/penn-chord.h"
 #include "ns3/penn-search-message.h"
+#include "ns3/penn-index-snapshot.h"
+#include "ns3/penn-boolean-query.h"
+#include "ns3/penn-merkle-tree.h"
+#include "ns3/penn-min-hash.h"
+#include "ns3/penn-term-store.h"
+#include "ns3/penn-write-ahead-log.h"
 #include "ns3/ping-request.h"
 
 #include "ns3/ipv4-address.h"
@@ -36,6 +42,7 @@
 #include "ns3/boolean.h"
 
 #include <unordered_map>
+#include <deque>
 
 using namespace ns3;
 
@@ -55,7 +62,10 @@ class PennSearch : public PennApplication
     uint32_t GetNextTransactionId ();
 
     // m2
-    void ProcessInvertedMsg(PennSearchMessage message);
+    void ProcessInvertedMsg(PennSearchMessage message, Ipv4Address sourceAddress);
+    // every INVERTED_MSG goes out through here, chunked when it doesn't fit one datagram
+    void SendInvertedMessage(PennSearchMessage message, Ipv4Address destAddress);
+    void ProcessChunkMsg(PennSearchMessage message, Ipv4Address sourceAddress);
     // m2b
     void processNodeJoinReq(PennSearchMessage message);
 
@@ -66,7 +76,12 @@ class PennSearch : public PennApplication
     // m2
     // std::string 
     // uint32_t transactionID
-    void HandleNodeLookup (Ipv4Address destAddress, std::string message, uint32_t transactionID);
+    // the owner found by the lookup is responsible for the key range (rangeStartKey, ownerKey)
+    void HandleNodeLookup (Ipv4Address destAddress, std::string message, uint32_t transactionID,
+                           uint32_t rangeStartKey, uint32_t ownerKey);
+
+    // a query lookup for searchKey passes through me, true if my path cache answers it
+    bool HandlePathLookup(uint32_t searchKey);
 
     // m2b
     void HandleNodeJoin(Ipv4Address destAddress);
@@ -85,14 +100,188 @@ class PennSearch : public PennApplication
     // m2 business logic related functions
     void processInvertedStore(PennSearchMessage message);
     void initInvertedSearch(PennSearchMessage message);
-    void processInvertedSearch(PennSearchMessage message);
+    // shardResult: the gathered postings of a sharded first keyword, instead of a local lookup
+    void processInvertedSearch(PennSearchMessage message, Ipv4Address sourceAddress,
+                               std::set<std::string> const *shardResult = NULL);
     void processInvertedSearchResult(PennSearchMessage message);
+    // the end of a search chain sends the result to the originator, in pages of ResultPageSize,
+    // naming the terms found to have no posting list at all
+    void sendSearchResult(Ipv4Address originatorIp, std::set<std::string> const &docIDs, uint32_t hopCount,
+                          uint32_t termKey, uint32_t originatorKey,
+                          std::map<std::string, PennSearchMessage::TermVersion> const &termVersions,
+                          std::vector<std::string> const &absentTerms = std::vector<std::string>(),
+                          std::string const &queryKey = std::string());
+    void sendResultPage(uint32_t token, uint32_t pageIndex);
+    void processResultPage(PennSearchMessage message, Ipv4Address sourceAddress);
+    void requestResultPage(Ipv4Address holderIp, uint32_t token, uint32_t pageIndex);
+    void retryResultPages(Ipv4Address holderIp, uint32_t token);
+    void processPageReq(PennSearchMessage message);
+    // boolean queries
+    void initBooleanSearch(PennSearchMessage message);
+    void processBoolStats(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processBoolStatsRsp(PennSearchMessage message);
+    void startBoolEval(uint32_t queryId);
+    void processBoolEval(PennSearchMessage message, Ipv4Address sourceAddress,
+                         std::set<std::string> const *shardResult = NULL);
     // helper
-    void splitStr(std::string const &line, const char delimeter, std::vector<std::string> &vec);
-    std::set<std::string> setIntersection(std::set<std::string> set1, std::set<std::string> set2);
+    // a token of a memory-mapped keys file, pointing into the mapping (no copy)
+    struct TokenRef {
+      const char *data;
+      size_t length;
+    };
+    static void tokenizeLine(const char *lineBegin, const char *lineEnd, std::vector<TokenRef> &tokens);
+    // a keys file line parsed off the simulator thread, applied to the index in file order
+    struct ParsedLine {
+      std::string doc;
+      std::vector<std::string> terms;   // in line order, duplicates kept
+      std::set<std::string> termSet;
+      std::vector<uint32_t> signature;  // MinHash of termSet, empty if it has no term
+      std::vector<std::string> rejectedTerms; // holding '*', no query could tell them from a wildcard
+    };
+    static void parsePublishLines(std::vector<TokenRef> const &lines, size_t begin, size_t end,
+                                  std::vector<ParsedLine> &parsed);
+    static std::set<std::string> setIntersection(std::set<std::string> const &set1, std::set<std::string> const &set2);
     // publish & store
-    void constructInvertedList(std::string fileName);
+    void constructInvertedList(std::string fileName, bool republish = false);
+    void unpublishDocument(std::string const &doc, std::vector<std::string> &newTerms);
+    void queuePublishPosting(std::string const &term, std::string const &doc, std::vector<std::string> &newTerms);
+    void queueUnpublishPosting(std::string const &term, std::string const &doc, std::vector<std::string> &newTerms);
+    void parsePublishChunk();
+    void routeParsedTerms(std::vector<std::string> const &terms);
+    bool findOwnerRange(uint32_t termKey, Ipv4Address &owner);
+    void resolveStoreRanges();
+    void issueStoreRangeLookup(std::string const &term, uint32_t attempts);
+    void expireStoreRangeLookup(uint32_t transactionID);
+    void resumeStalledPublish();
+    void collectPendingStores(uint32_t rangeStartKey, uint32_t ownerKey, std::vector<std::string> &terms);
+    void sendStoreBatches(Ipv4Address destAddress, std::vector<std::string> const &terms);
+    void batchPostingLists(Ipv4Address destAddress, std::string const &batchType,
+                           std::unordered_map<std::string, std::set<std::string> > &postingLists,
+                           std::vector<std::string> const &terms);
+    void sendStoreBatch(Ipv4Address destAddress, std::string const &batchType,
+                        std::map<std::string, std::set<std::string> > const &postings);
+    bool storeLocally(std::string const &term, std::set<std::string> const &docIDs);
+    void ownTerm(std::string const &term);
+    void dropTerm(std::string const &term);
+    void collectKeyRange(uint32_t rangeStartKey, uint32_t rangeEndKey,
+                         std::map<std::string, std::set<std::string> > &postings);
+    void sendHandoff(Ipv4Address destAddress, std::map<std::string, std::set<std::string> > const &postings);
+    bool removeLocally(std::string const &term, std::set<std::string> const &docIDs);
+    static bool isInRange(uint32_t rangeStartKey, uint32_t rangeEndKey, uint32_t key);
+    // replication
+    void replicatePostings(std::string const &subtype, std::map<std::string, std::set<std::string> > const &postings,
+                           Ipv4Address ownerIp, uint32_t position);
+    void processReplicaStore(PennSearchMessage message);
+    void processReplicaAck(PennSearchMessage message);
+    void sendReplicaAck(Ipv4Address ownerIp, uint32_t position);
+    bool pruneReplicaHolders();
+    void refillReplicaChain(uint32_t predKey, Ipv4Address succIp);
+    void sendReplicaInfo(Ipv4Address destAddress);
+    void processReplicaInfo(PennSearchMessage message);
+    bool findReadReplica(uint32_t termKey, Ipv4Address &replica);
+    // anti-entropy between an owner and its replicas
+    void AntiEntropyTimerExpired();
+    void buildMerkleTree(uint32_t rangeStartKey, uint32_t rangeEndKey, bool replica, PennMerkleTree &tree);
+    void processMerkleSync(PennSearchMessage message);
+    void processMerkleDiff(PennSearchMessage message);
+    void processMerkleRepair(PennSearchMessage message);
+    bool lookupPostings(std::string const &term, std::set<std::string> &docIDs);
+    // log-structured term store upkeep
+    void flushTermStore();
+    void compactTermStore();
+    void flushForwardIndex();
+    void compactForwardIndex();
+    void flushReplicaDatabase();
+    void compactReplicaDatabase();
+    void bumpTermVersion(std::string const &term);
+    // term store writes, logged ahead when durable
+    void writeTermStore(std::string const &term, std::string const &doc, bool present);
+    // on-disk snapshot
+    std::string snapshotFileName();
+    void faultInSnapshotTerm(std::string const &term);
+    void faultInSnapshot();
+    void writeSnapshot();
+    void SnapshotTimerExpired();
+    // write-ahead log next to the snapshot
+    std::string walFileName();
+    void replayWal();
+    void WalCommitTimerExpired();
+    // hot term sharding
+    static std::string shardKey(std::string const &term, uint32_t shardIndex);
+    static std::string shardMarker(uint32_t shardCount);
+    static bool shardCountOf(std::set<std::string> const &docIDs, uint32_t &shardCount);
+    static bool parseShardMarker(std::string const &doc, uint32_t &shardCount);
+    bool storedShardCount(std::string const &term, uint32_t &shardCount);
+    static uint32_t docShard(std::string const &doc, uint32_t shardCount);
+    static bool isShardKey(std::string const &term);
+    void splitTerm(std::string const &term);
+    void divertToShards(std::string const &term);
+    void scheduleShardFlush();
+    void flushShardPostings();
+    void scatterShardSearch(PennSearchMessage message, Ipv4Address sourceAddress, uint32_t shardCount);
+    void processShardSearch(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processShardResult(PennSearchMessage message);
+    void finishShardGather(uint32_t gatherId);
+    void expireShardGather(uint32_t gatherId);
+    // prefix index for wildcard search
+    static std::string prefixKey(std::string const &prefix);
+    static bool isPrefixKey(std::string const &term);
+    std::string prefixIndexKey(std::string const &wildcard);
+    void indexPrefixes(std::string const &term, bool remove);
+    static bool isIndexKey(std::string const &term);
+    // similarity search over MinHash LSH buckets
+    static std::string lshBucketKey(std::string const &bucket);
+    static bool isLshKey(std::string const &term);
+    void queueSimilarityPostings(std::string const &doc, std::vector<uint32_t> const &signature, bool remove,
+                                 std::vector<std::string> &newTerms);
+    void queueSimilarityPostings(std::string const &doc, std::set<std::string> const &terms, bool remove,
+                                 std::vector<std::string> &newTerms);
+    void constructSimilarReq(Ipv4Address destAddress, std::vector<std::string> queryTerms, std::string const &queryDoc);
+    void initSimilarSearch(PennSearchMessage message);
+    void processSimilarProbe(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processSimilarProbeRsp(PennSearchMessage message);
+    void finishSimilarSearch(uint32_t queryId);
+    void processSimilarResult(PennSearchMessage message);
+    // document partitioned index: published postings stay on the publisher, a search visits the publishers
+    static std::string publishersKey();
+    static bool isPublishersKey(std::string const &term);
+    void registerPublisher(std::vector<std::string> &newTerms);
+    void evaluateLocalQuery(std::vector<std::string> const &queryTerms, std::set<std::string> &docIDs);
+    void initDocumentSearch(PennSearchMessage message);
+    void processDocumentPeers(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processDocumentPeersRsp(PennSearchMessage message);
+    void processDocumentSearch(PennSearchMessage message);
+    void processDocumentSearchRsp(PennSearchMessage message);
+    void finishDocumentSearch(uint32_t queryId);
+    // chunked transfer
+    void sendChunkWindow(uint32_t streamId);
+    void sendChunkSegment(uint32_t streamId, uint32_t sequenceNumber);
+    void retransmitChunks(uint32_t streamId);
+    // lookup scheduling: interactive searches go ahead of publish and path cache lookups
+    enum LookupPriority {
+      LOOKUP_SEARCH,
+      LOOKUP_PUBLISH,
+      LOOKUP_CACHE_FETCH
+    };
+    void issueLookup(uint32_t txID, uint32_t searchKey, LookupPriority priority);
+    void startQueuedLookups();
+    bool isOverloaded();
+    void processBusy(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processSearchFailed(PennSearchMessage message, Ipv4Address sourceAddress);
+    // path caching
+    bool hasPathCache(uint32_t termKey);
+    void expireCacheFetch(uint32_t searchKey, uint32_t transactionID);
+    void processCacheFetch(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processCacheFill(PennSearchMessage message);
     // search
+    bool searchFromCache(Ipv4Address viaNodeAddr, std::vector<std::string> const &queryTerms);
+    bool searchFromNegativeCache(std::vector<std::string> const &queryTerms);
+    void processVersionProbe(PennSearchMessage message, Ipv4Address sourceAddress);
+    void processVersionRsp(PennSearchMessage message);
+    void expireCacheProbe(uint32_t transactionID);
+    bool heldTermVersion(std::string const &term, uint32_t &version);
+    void logSearchResults(std::set<std::string> const &docIDs);
+    static std::string queryCacheKey(std::vector<std::string> const &queryTerms);
     // void constructSearchReq(Ipv4Address destAddress, std::string queryConcat);
     void constructInitSearchReq(Ipv4Address destAddress, std::vector<std::string> queryTerms);
   
@@ -115,17 +304,232 @@ class PennSearch : public PennApplication
     Ptr<Socket> m_socket;
     Time m_pingTimeout;
     uint16_t m_appPort, m_chordPort;
+    // upper bound (bytes) of the serialized store_batch message
+    uint32_t m_storeBatchSize;
+    // streaming publish: lines parsed per scheduled chunk, and the parsed-but-unshipped
+    // term count above which parsing waits for the network to catch up
+    uint32_t m_publishChunkLines;
+    uint32_t m_publishThreads;
+    uint32_t m_publishMaxPendingTerms;
+    // how long a resolved owner range is trusted for routing later chunks
+    Time m_ownerRangeTimeout;
+    // number of nodes holding each posting list: the owner and its ReplicationFactor-1 successors
+    uint32_t m_replicationFactor;
+    // how long a learned replica set is used to route reads
+    Time m_replicaInfoTimeout;
+    // max number of query results cached at this node (0 disables the cache)
+    uint32_t m_queryCacheSize;
+    // how long a term a search found absent is taken as absent by this query node (0 disables)
+    Time m_negativeCacheTtl;
+    // query lookups per second for one key, seen on the path, above which I cache its posting lists (0 disables)
+    uint32_t m_pathCacheThreshold;
+    Time m_pathCacheTtl;
+    // chunked transfer: segment payload bytes, receiver window in segments, retransmit timeout
+    uint32_t m_chunkSize;
+    uint32_t m_chunkWindow;
+    Time m_chunkRetransmitTimeout;
+    // where my term store snapshot lives (empty disables snapshots), and how often a changed store is written
+    std::string m_snapshotDirectory;
+    Time m_snapshotInterval;
+    // longest a term store write waits for its group commit, and the group size that commits at once
+    Time m_walCommitInterval;
+    uint32_t m_walCommitSize;
+    // an owned posting list reaching ShardListSize docIDs, or searched ShardQueryRate times a second,
+    // is split into ShardCount sub-keys term#0..term#ShardCount-1 (0 disables either trigger)
+    uint32_t m_shardListSize;
+    uint32_t m_shardQueryRate;
+    uint32_t m_shardCount;
+    // every term is listed under its prefixes of up to PrefixIndexLength characters (0 disables)
+    uint32_t m_prefixIndexLength;
+    // most similar documents a SIMILAR query returns
+    uint32_t m_similarResultCount;
+    // term partitioned: a posting lives on its term's owner. Document partitioned: on its publisher,
+    // a search is sent to at most DocumentSearchFanout publishers (0: all of them)
+    enum IndexPartitioning {
+      TERM_PARTITIONED,
+      DOCUMENT_PARTITIONED
+    };
+    IndexPartitioning m_indexPartitioning;
+    uint32_t m_documentSearchFanout;
+    // term store: postings buffered before a flush to a sorted run, runs kept before they are compacted
+    uint32_t m_termStoreBufferSize;
+    uint32_t m_termStoreMaxRuns;
+    // heap bytes the term store may hold before cold posting lists are spilled next to the snapshot (0: unbounded)
+    uint64_t m_termStoreMemoryBudget;
+    // how often an owner compares its key range with each of its replicas (0 disables)
+    Time m_antiEntropyInterval;
+    // Chord lookups in flight at once, queued lookups above which search steps are turned away
+    // (0 never turns away), and the retry delay a turned away sender is given
+    uint32_t m_maxConcurrentLookups;
+    // docIDs per search_result_page, larger results are paged (0 sends every result whole)
+    uint32_t m_resultPageSize;
+    // pages of a result sent ahead of the first one the originator misses, and how long the
+    // originator waits for a new page before it asks for the missing one again
+    uint32_t m_resultPageWindow;
+    Time m_resultPageTimeout;
+    uint32_t m_overloadQueueLength;
+    Time m_busyRetryDelay;
+    // times a search step is turned away busy before the query node is told it failed
+    uint32_t m_busyRetryLimit;
     // Timers
     Timer m_auditPingsTimer;
+    Timer m_snapshotTimer;
+    Timer m_walCommitTimer;
+    Timer m_antiEntropyTimer;
     // Ping tracker
     std::map<uint32_t, Ptr<PingRequest> > m_pingTracker;
 
     // m2
     // publish parsed read file data
     std::unordered_map<std::string, std::set<std::string> > m_invertLists;
+    // <term, docIDs> to be removed from the term owners, queued the same way as m_invertLists
+    std::unordered_map<std::string, std::set<std::string> > m_removeLists;
+
+    // forward index of the documents published from this node: docID -> terms, kept in a term store
+    // of its own so TermStoreMemoryBudget bounds it too
+    // REPUBLISH and UNPUBLISH diff against it so only the changed postings travel; they only know
+    // the documents published from this node
+    PennTermStore m_forwardIndex;
+    bool m_forwardCompactionScheduled = false;
+    // document partitioned: inverted index of the documents published from this node, sorted for wildcards
+    std::map<std::string, std::set<std::string> > m_documentIndex;
+    // my node id is listed under the publishers key
+    bool m_publisherRegistered = false;
 
     // data structure to store the key(keyword/term) and values(docIDs) whose key is hashed to this node
-    std::unordered_map<std::string, std::set<std::string> > m_searchDatabase;
+    // writes are buffered and flushed to sorted runs, merged by compactTermStore between events
+    PennTermStore m_searchDatabase;
+    bool m_compactionScheduled = false;
+    // the terms of m_searchDatabase ordered by (term key, term), a key range is one contiguous run
+    std::set<std::pair<uint32_t, std::string> > m_termsByKey;
+
+    // the snapshot loaded at start, read in place; a term is copied into m_searchDatabase
+    // the first time it is touched and from then on m_searchDatabase alone is authoritative for it
+    PennIndexSnapshot m_snapshot;
+    std::set<std::string> m_snapshotFaultedTerms;
+    // the term store changed since the last snapshot was written
+    bool m_snapshotDirty = false;
+    // term store writes since the last snapshot, replayed over it at start
+    PennWriteAheadLog m_wal;
+
+    // a sharded term keeps only shardMarker(shardCount) as its posting list, the docIDs live under
+    // its sub-keys, one contiguous range of the docID key space each. Postings still sent to the term
+    // are passed on to the sub-key owners, through the publish queues.
+    // The prefix index entries of the terms I gain or lose go out the same way
+    std::map<std::string, std::set<std::string> > m_shardStores;
+    std::map<std::string, std::set<std::string> > m_shardRemoves;
+    bool m_shardFlushScheduled = false;
+    // searches per second of each term I own, over the current one second window
+    struct TermSearchRate {
+      Time windowStart;
+      uint32_t count;
+    };
+    std::unordered_map<std::string, TermSearchRate> m_termSearchRates;
+
+    // copies of posting lists owned by my predecessors, written down the replica chain; a term store
+    // of its own so TermStoreMemoryBudget bounds it too
+    PennTermStore m_replicaDatabase;
+    bool m_replicaCompactionScheduled = false;
+    // as an owner: position in my replica chain -> node holding that copy, and when it last
+    // acknowledged a write or an in sync anti-entropy round; silent for ReplicaInfoTimeout it is dropped
+    struct ReplicaHolder {
+      Ipv4Address holderIp;
+      Time ackedAt;
+    };
+    std::map<uint32_t, ReplicaHolder> m_replicaHolders;
+    // as an owner: the key range start and the successor my replica chain was last filled for
+    uint32_t m_replicaChainPredKey = 0;
+    Ipv4Address m_replicaChainSuccIp;
+    // as an owner: the tree of my range built at the start of the anti-entropy round, every
+    // replica's sync of that round descends it
+    PennMerkleTree m_roundMerkleTree;
+    uint32_t m_roundMerkleStartKey = 0;
+    uint32_t m_roundMerkleEndKey = 0;
+    // as a replica: owner -> my position in its replica chain
+    std::map<Ipv4Address, uint32_t> m_replicaPositions;
+    // as an owner: when each reader was last told about my replicas
+    std::map<Ipv4Address, Time> m_replicaInfoSent;
+
+    // as a reader: replica sets of the owners I searched, ownerKey -> (rangeStartKey, owner first, learned at)
+    struct ReplicaSet {
+      uint32_t rangeStartKey;
+      std::vector<Ipv4Address> replicas;
+      Time learnedAt;
+    };
+    std::map<uint32_t, ReplicaSet> m_replicaSets;
+    // smoothed ping RTT (microseconds) of the replicas I may read from
+    std::map<Ipv4Address, int64_t> m_replicaRtt;
+
+    // per-term version of the posting lists I hold, set from m_termVersionClock on every change so a
+    // term that goes and comes back never repeats a version. The versions of dropped terms are
+    // forgotten, and under TermStoreMemoryBudget arbitrary ones beyond m_termVersionLimit too: a
+    // held term without a version gets a fresh one, which only makes cached results miss
+    std::unordered_map<std::string, uint32_t> m_termVersions;
+    uint32_t m_termVersionClock = 0;
+    size_t m_termVersionLimit = 0;
+
+    // results of my past queries, keyed by the sorted term set, valid while every term version still matches
+    struct CachedResult {
+      std::set<std::string> docIDs;
+      std::map<std::string, PennSearchMessage::TermVersion> termVersions;
+      Time lastUsed;
+    };
+    std::unordered_map<std::string, CachedResult> m_queryCache;
+    // terms my searches found absent -> when that stops being trusted
+    std::unordered_map<std::string, Time> m_absentTerms;
+
+    // a cached result waiting for its holders to confirm the versions, keyed by probe txID
+    struct CacheProbe {
+      std::string cacheKey;
+      Ipv4Address viaNodeAddr;
+      std::vector<std::string> queryTerms;
+      uint32_t pendingHolders;
+      bool stale;
+    };
+    std::unordered_map<uint32_t, CacheProbe> m_cacheProbes;
+
+    // messages being sent in segments, keyed by stream id
+    struct OutgoingStream {
+      Ipv4Address destAddress;
+      std::vector<uint8_t> bytes; // the serialized message
+      uint32_t segmentCount;
+      std::vector<bool> acked;
+      uint32_t ackedCount;
+      std::vector<Time> sentAt; // last (re)transmission of each segment below nextToSend
+      uint32_t nextToSend; // first segment never sent
+      uint32_t cumulativeAck; // every segment below it is acked
+      uint32_t window; // as last advertised by the receiver
+      uint32_t retries; // retransmit rounds without progress
+      EventId retransmitEvent;
+    };
+    std::map<uint32_t, OutgoingStream> m_outgoingStreams;
+
+    // messages being reassembled, keyed by (sender, stream id)
+    struct IncomingStream {
+      uint32_t segmentCount; // 0 until the first segment arrives
+      std::vector<std::vector<uint8_t> > segments;
+      std::vector<bool> received;
+      uint32_t receivedCount;
+      uint32_t cumulative; // every segment below it has arrived
+      bool delivered; // kept after delivery to re-ack duplicates
+      Time lastActivity;
+    };
+    std::map<std::pair<Ipv4Address, uint32_t>, IncomingStream> m_incomingStreams;
+
+    // posting lists of hot keys whose query lookups pass through me, served until expiresAt
+    struct PathCacheEntry {
+      std::map<std::string, std::set<std::string> > postings; // every term of the key the owner holds
+      Time expiresAt;
+    };
+    std::map<uint32_t, PathCacheEntry> m_pathCache;
+    // query lookup rate per key over the current one second window
+    struct PathKeyRate {
+      Time windowStart;
+      uint32_t count;
+      bool fetching; // a cache_fetch for the key is in flight
+      uint32_t fetchTxID; // its lookup's txID
+    };
+    std::unordered_map<uint32_t, PathKeyRate> m_pathKeyRates;
 
     // lookup chord node address
     Ipv4Address m_lookupNodeIp;
@@ -134,6 +538,37 @@ class PennSearch : public PennApplication
     uint32_t lookupNumber = 0;
     uint32_t hopNumber = 0;
 
+    // publish terms whose owner is not resolved yet, ordered by term hash so that
+    // one resolved owner range drains every pending term falling into it
+    std::set<std::pair<uint32_t, std::string> > m_pendingStores;
+
+    // owner ranges learned during publish: ownerKey -> (rangeStartKey, owner ip, learned at)
+    struct OwnerRange {
+      uint32_t rangeStartKey;
+      Ipv4Address ownerIp;
+      Time learnedAt;
+    };
+    std::map<uint32_t, OwnerRange> m_ownerRanges;
+
+    // keys files being published, memory-mapped and parsed front to back one chunk per event
+    struct PublishStream {
+      std::string fileName;
+      int fd;
+      const char *data;
+      size_t size;
+      size_t offset; // next byte to parse
+      size_t releasedOffset; // pages before this were handed back to the kernel
+      bool republish; // each line replaces the document's previous term set
+    };
+    std::deque<PublishStream> m_publishStreams;
+    bool m_publishParseScheduled = false;
+    // parsing stopped because too many parsed terms are still waiting for their owner
+    bool m_publishStalled = false;
+
+    // number of store_batch messages sent & number of terms they carried
+    uint32_t storeBatchNumber = 0;
+    uint32_t storeBatchTermNumber = 0;
+
     // to keep track of storing and searching jobs with transactionID
     struct SearchInfo {
 
@@ -152,12 +587,127 @@ class PennSearch : public PennApplication
       uint32_t termKey;
       uint32_t originatorKey;
       uint32_t destinationKey;
+
+      // versions of the terms served so far, for the originator's query cache
+      std::map<std::string, PennSearchMessage::TermVersion> termVersions;
+
+      // shard_search/bool_stats: id the answer comes back under, sent as the message's transaction id
+      uint32_t replyId;
+
+      // bool_eval: intermediate results of the boolean query so far
+      std::vector<std::set<std::string> > resultStack;
+
+      // search: the originator's cache key of the whole query
+      std::string queryKey;
     };
 
-    // store: txID maps to term whose docIDS set is To be Sent and store to the destIP while handling callback 
+    // store: txID maps to the pending term whose owner range is being resolved, and how many
+    // range lookups it has taken so far
     // search: txID maps to related SearchInfo
-    std::unordered_map<uint32_t, std::string> m_storeJobs;
+    struct StoreJob {
+      std::string term;
+      uint32_t attempts;
+    };
+    std::unordered_map<uint32_t, StoreJob> m_storeJobs;
     std::unordered_map<uint32_t, SearchInfo> m_searchJobs;
+    // the search lookup in flight for each term key, later searches of the key ride on it.
+    // It ages from when it leaves the lookup queue, a queued lookup is never stale
+    struct KeyLookup {
+      uint32_t txID;
+      bool sent;
+      Time sentAt;
+    };
+    std::unordered_map<uint32_t, KeyLookup> m_searchLookups;
+    // search txID -> the searches attached to its lookup, forwarded with it
+    std::unordered_map<uint32_t, std::vector<SearchInfo> > m_coalescedSearches;
+    // cache fetch: txID maps to the hot key whose owner is being looked up
+    std::unordered_map<uint32_t, uint32_t> m_cacheFetchJobs;
+
+    // lookups waiting for a free slot, ordered by (priority, arrival)
+    struct QueuedLookup {
+      uint32_t txID;
+      uint32_t searchKey;
+      LookupPriority priority;
+    };
+    std::map<std::pair<uint32_t, uint64_t>, QueuedLookup> m_lookupQueue;
+    uint64_t m_lookupSequence = 0;
+    // paged results I hold for an originator, keyed by continuation token. The originator has
+    // pages [0, ackedCount), pages [0, sentCount) were sent, up to ResultPageWindow past ackedCount
+    struct ResultCursor {
+      Ipv4Address originatorIp;
+      std::vector<std::set<std::string> > pages;
+      std::map<std::string, PennSearchMessage::TermVersion> termVersions;
+      uint32_t hopCount;
+      uint32_t termKey;
+      uint32_t originatorKey;
+      std::string queryKey;
+      uint32_t ackedCount;
+      uint32_t sentCount;
+      Time lastUsed;
+    };
+    std::unordered_map<uint32_t, ResultCursor> m_resultCursors;
+    // as the originator: the pages of a result received so far, keyed by (sender, token), and the
+    // first page missing; lastUsed is when a new page last came in
+    struct PagedResult {
+      std::set<std::string> docIDs;
+      std::set<uint32_t> received;
+      uint32_t pageCount;
+      uint32_t firstMissing;
+      // from the last page
+      std::map<std::string, PennSearchMessage::TermVersion> termVersions;
+      std::string queryKey;
+      Time lastUsed;
+    };
+    std::map<std::pair<Ipv4Address, uint32_t>, PagedResult> m_pagedResults;
+
+    // lookups in flight: txID -> when it was sent
+    std::unordered_map<uint32_t, Time> m_activeLookups;
+
+    // send the search step to the node holding its first keyword
+    void forwardSearch(SearchInfo const &searchInfo, Ipv4Address destAddress);
+    // read the first keyword from my path cache or a known replica, or look its owner up
+    void routeSearch(SearchInfo const &searchInfo);
+
+    // a search step waiting for the shards of its sharded keyword, keyed by gather id
+    struct ShardGather {
+      PennSearchMessage message; // the step, resumed once every shard answered
+      Ipv4Address sourceAddress;
+      uint32_t pendingShards;
+      std::set<std::string> docIDs;
+      std::map<std::string, PennSearchMessage::TermVersion> termVersions;
+    };
+    std::unordered_map<uint32_t, ShardGather> m_shardGathers;
+
+    // a boolean query waiting for the posting list sizes of its terms before it is planned, keyed by query id
+    struct BooleanSearch {
+      PennBooleanQuery query;
+      Ipv4Address originatorIp;
+      std::map<std::string, uint32_t> listSizes;
+      // wildcard term -> the terms the prefix index matched
+      std::map<std::string, std::set<std::string> > expansions;
+      uint32_t pendingTerms;
+    };
+    std::unordered_map<uint32_t, BooleanSearch> m_booleanSearches;
+
+    // as the via node of a SIMILAR query: its signature, and the candidates found in its buckets so far
+    struct SimilarSearch {
+      std::string signature;
+      std::string queryDoc;
+      Ipv4Address originatorIp;
+      // docID -> encoded signature
+      std::map<std::string, std::string> candidates;
+      uint32_t pendingBuckets;
+    };
+    std::unordered_map<uint32_t, SimilarSearch> m_similarSearches;
+
+    // as the via node of a document partitioned search: the publishers asked and the union of their answers
+    struct DocumentSearch {
+      std::vector<std::string> queryTerms;
+      Ipv4Address originatorIp;
+      std::set<std::string> docIDs;
+      uint32_t pendingPeers;
+    };
+    std::unordered_map<uint32_t, DocumentSearch> m_documentSearches;
 
 
 
@@ -0,0 +1,821 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-term-store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// heap node of a std::map besides its value: color, parent, left and right, the color padded to a pointer
+static const uint64_t MAP_NODE_BYTES = 4 * sizeof (void *);
+// dead segment bytes below which the segment is not worth rewriting
+static const uint64_t SEGMENT_REWRITE_MIN_BYTES = 1;
+
+PennTermStore::PennTermStore ()
+  : m_bufferSize (4096),
+    m_maxRuns (4),
+    m_bufferBytes (0),
+    m_indexBytes (0),
+    m_memoryBudget (0),
+    m_segmentFd (-1),
+    m_segmentSize (0),
+    m_segmentDeadBytes (0),
+    m_spillCompactionPending (false),
+    m_tick (0)
+{
+}
+
+PennTermStore::~PennTermStore ()
+{
+  if (m_segmentFd >= 0)
+    {
+      close (m_segmentFd);
+    }
+}
+
+void
+PennTermStore::SetLimits (uint32_t bufferSize, uint32_t maxRuns)
+{
+  m_bufferSize = bufferSize;
+  m_maxRuns = maxRuns;
+}
+
+bool
+PennTermStore::SetMemoryBudget (uint64_t budget, std::string const &segmentFile)
+{
+  if (m_segmentFd >= 0)
+    {
+      close (m_segmentFd);
+    }
+  // the segment is scratch, what it held is in the snapshot and the write-ahead log
+  m_segmentFile = segmentFile;
+  m_segmentFd = open (segmentFile.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  m_segmentSize = 0;
+  m_segmentDeadBytes = 0;
+  m_memoryBudget = (m_segmentFd >= 0) ? budget : 0;
+  return m_segmentFd >= 0;
+}
+
+void
+PennTermStore::Add (std::string const &term, std::string const &doc)
+{
+  Touch (term);
+  FaultIn (term);
+  auto inserted = m_buffer.insert (std::make_pair (std::make_pair (term, doc), true));
+  if (inserted.second)
+    {
+      m_bufferBytes += MAP_NODE_BYTES + sizeof (*inserted.first) + StringBytes (inserted.first->first.first)
+                       + StringBytes (inserted.first->first.second);
+    }
+  inserted.first->second = true;
+}
+
+void
+PennTermStore::Remove (std::string const &term, std::string const &doc)
+{
+  Touch (term);
+  FaultIn (term);
+  auto inserted = m_buffer.insert (std::make_pair (std::make_pair (term, doc), false));
+  uint64_t entryBytes = MAP_NODE_BYTES + sizeof (*inserted.first) + StringBytes (inserted.first->first.first)
+                        + StringBytes (inserted.first->first.second);
+  // without runs there is nothing older to shadow
+  if (m_runs.empty ())
+    {
+      if (!inserted.second)
+        {
+          m_bufferBytes -= entryBytes;
+        }
+      m_buffer.erase (inserted.first);
+      return;
+    }
+  if (inserted.second)
+    {
+      m_bufferBytes += entryBytes;
+    }
+  inserted.first->second = false;
+}
+
+bool
+PennTermStore::Get (std::string const &term, std::set<std::string> &docIDs)
+{
+  FaultIn (term);
+  if (!Merge (term, docIDs))
+    {
+      return false;
+    }
+  Touch (term);
+  return true;
+}
+
+bool
+PennTermStore::Merge (std::string const &term, std::set<std::string> &docIDs) const
+{
+  docIDs.clear ();
+  Walk (term, std::string (), [&docIDs] (Slice const &doc) {
+    docIDs.insert (docIDs.end (), std::string (doc.data, doc.length));
+    return true;
+  });
+  return !docIDs.empty ();
+}
+
+void
+PennTermStore::Walk (std::string const &term, std::string const &from,
+                     std::function<bool (Slice const &)> const &visit) const
+{
+  // the stretch of term's block at or above from in each run holding it, oldest first
+  std::vector<std::pair<DocEntry const *, DocEntry const *> > blocks;
+  std::vector<Run const *> blockRuns;
+  for (auto const &run : m_runs)
+    {
+      uint32_t termIndex = Find (run, term);
+      if (termIndex == run.terms.size ())
+        {
+          continue;
+        }
+      DocEntry const *first = run.docs.data () + run.terms[termIndex].firstDoc;
+      DocEntry const *last = first + run.terms[termIndex].docCount;
+      first = std::lower_bound (first, last, from, [&run] (DocEntry const &docEntry, std::string const &f) {
+        return run.pool.compare (docEntry.docOffset, docEntry.docLength, f) < 0;
+      });
+      blocks.push_back (std::make_pair (first, last));
+      blockRuns.push_back (&run);
+    }
+  auto bufferIter = m_buffer.lower_bound (std::make_pair (term, from));
+
+  while (true)
+    {
+      bool found = false;
+      Slice doc = { NULL, 0 };
+      for (size_t b = 0; b < blocks.size (); ++b)
+        {
+          if (blocks[b].first != blocks[b].second)
+            {
+              Slice runDoc = DocOf (*blockRuns[b], *blocks[b].first);
+              if (!found || Compare (runDoc, doc) < 0)
+                {
+                  doc = runDoc;
+                  found = true;
+                }
+            }
+        }
+      bool inBuffer = bufferIter != m_buffer.end () && bufferIter->first.first == term;
+      if (inBuffer && (!found || Compare (SliceOf (bufferIter->first.second), doc) < 0))
+        {
+          doc = SliceOf (bufferIter->first.second);
+          found = true;
+        }
+      if (!found)
+        {
+          return;
+        }
+
+      // every source at doc steps past it, the newest one decides
+      bool present = false;
+      for (size_t b = 0; b < blocks.size (); ++b)
+        {
+          if (blocks[b].first != blocks[b].second && Compare (DocOf (*blockRuns[b], *blocks[b].first), doc) == 0)
+            {
+              present = blocks[b].first->present;
+              ++blocks[b].first;
+            }
+        }
+      if (inBuffer && Compare (SliceOf (bufferIter->first.second), doc) == 0)
+        {
+          present = bufferIter->second;
+          ++bufferIter;
+        }
+      if (present && !visit (doc))
+        {
+          return;
+        }
+    }
+}
+
+bool
+PennTermStore::Contains (std::string const &term) const
+{
+  if (m_spilled.find (term) != m_spilled.end ())
+    {
+      return true;
+    }
+  // the first docID still present will do
+  bool found = false;
+  Walk (term, std::string (), [&found] (Slice const &) {
+    found = true;
+    return false;
+  });
+  return found;
+}
+
+bool
+PennTermStore::Contains (std::string const &term, std::string const &doc)
+{
+  FaultIn (term);
+  auto bufferFind = m_buffer.find (std::make_pair (term, doc));
+  if (bufferFind != m_buffer.end ())
+    {
+      return bufferFind->second;
+    }
+  // newest run first, the first one to hold the docID decides
+  for (auto runIter = m_runs.rbegin (); runIter != m_runs.rend (); ++runIter)
+    {
+      Run const &run = *runIter;
+      uint32_t termIndex = Find (run, term);
+      if (termIndex == run.terms.size ())
+        {
+          continue;
+        }
+      DocEntry const *first = run.docs.data () + run.terms[termIndex].firstDoc;
+      DocEntry const *last = first + run.terms[termIndex].docCount;
+      DocEntry const *docFind = std::lower_bound (first, last, doc, [&run] (DocEntry const &docEntry, std::string const &d) {
+        return run.pool.compare (docEntry.docOffset, docEntry.docLength, d) < 0;
+      });
+      if (docFind != last && run.pool.compare (docFind->docOffset, docFind->docLength, doc) == 0)
+        {
+          return docFind->present;
+        }
+    }
+  return false;
+}
+
+uint32_t
+PennTermStore::Count (std::string const &term)
+{
+  FaultIn (term);
+  uint32_t docCount = 0;
+  Walk (term, std::string (), [&docCount] (Slice const &) {
+    ++docCount;
+    return true;
+  });
+  return docCount;
+}
+
+bool
+PennTermStore::LowerBound (std::string const &term, std::string const &from, std::string &doc)
+{
+  FaultIn (term);
+  bool found = false;
+  Walk (term, from, [&found, &doc] (Slice const &lowest) {
+    doc.assign (lowest.data, lowest.length);
+    found = true;
+    return false;
+  });
+  return found;
+}
+
+void
+PennTermStore::GetAll (std::map<std::string, std::set<std::string> > &termStore) const
+{
+  std::set<std::string> terms;
+  for (auto const &run : m_runs)
+    {
+      for (auto const &termEntry : run.terms)
+        {
+          Slice term = TermOf (run, termEntry);
+          terms.insert (terms.end (), std::string (term.data, term.length));
+        }
+    }
+  for (auto const &ent : m_buffer)
+    {
+      terms.insert (ent.first.first);
+    }
+  for (auto const &ent : m_spilled)
+    {
+      terms.insert (ent.first);
+    }
+
+  for (auto const &term : terms)
+    {
+      std::set<std::string> docIDs;
+      auto spillFind = m_spilled.find (term);
+      if (spillFind != m_spilled.end () ? ReadSpilled (spillFind->second, docIDs) : Merge (term, docIDs))
+        {
+          termStore[term].swap (docIDs);
+        }
+    }
+}
+
+bool
+PennTermStore::NeedsFlush () const
+{
+  return m_buffer.size () >= m_bufferSize;
+}
+
+void
+PennTermStore::Flush ()
+{
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+
+  // the buffer is sorted already, each term's entries are one stretch of it
+  Run run;
+  std::vector<std::pair<Slice, bool> > docs;
+  auto bufferIter = m_buffer.begin ();
+  while (bufferIter != m_buffer.end ())
+    {
+      std::string const &term = bufferIter->first.first;
+      docs.clear ();
+      auto termIter = bufferIter;
+      for (; termIter != m_buffer.end () && termIter->first.first == term; ++termIter)
+        {
+          docs.push_back (std::make_pair (SliceOf (termIter->first.second), termIter->second));
+        }
+      Append (run, SliceOf (term), docs);
+      bufferIter = termIter;
+    }
+
+  m_runs.push_back (run);
+  m_buffer.clear ();
+  m_bufferBytes = 0;
+}
+
+bool
+PennTermStore::NeedsCompaction () const
+{
+  return m_runs.size () > m_maxRuns || m_spillCompactionPending || NeedsSegmentRewrite ();
+}
+
+void
+PennTermStore::Compact ()
+{
+  if (NeedsSegmentRewrite ())
+    {
+      RewriteSegment ();
+    }
+  if (m_spillCompactionPending)
+    {
+      m_spillCompactionPending = false;
+      CompactFrom (0);
+      return;
+    }
+  if (m_runs.size () < 2)
+    {
+      return;
+    }
+  // the newest runs, enough of them to get back to m_maxRuns, and further back while the next older
+  // run is no larger than the merge: a docID is rewritten a logarithmic number of times, not at
+  // every compaction
+  size_t first = std::min (m_runs.size () - 2, (size_t) std::max (m_maxRuns, (uint32_t) 1) - 1);
+  uint64_t mergedBytes = 0;
+  for (size_t r = first; r < m_runs.size (); ++r)
+    {
+      mergedBytes += RunBytes (m_runs[r]);
+    }
+  while (first > 0 && RunBytes (m_runs[first - 1]) <= mergedBytes)
+    {
+      --first;
+      mergedBytes += RunBytes (m_runs[first]);
+    }
+  CompactFrom (first);
+}
+
+void
+PennTermStore::CompactFrom (size_t first)
+{
+  // a single run is rewritten only to drop the terms spilled out of it
+  if (m_runs.size () - first < 2 && (m_runs.size () == first || m_spilled.empty ()))
+    {
+      return;
+    }
+
+  // k-way merge over the runs' dictionaries, each run's cursor at its next term
+  size_t runCount = m_runs.size () - first;
+  Run const *runs = m_runs.data () + first;
+  std::vector<uint32_t> termCursors (runCount, 0);
+  Run merged;
+  std::vector<std::pair<Slice, bool> > docs;
+  std::string termString;
+  while (true)
+    {
+      bool found = false;
+      Slice term = { NULL, 0 };
+      for (size_t r = 0; r < runCount; ++r)
+        {
+          if (termCursors[r] < runs[r].terms.size ())
+            {
+              Slice runTerm = TermOf (runs[r], runs[r].terms[termCursors[r]]);
+              if (!found || Compare (runTerm, term) < 0)
+                {
+                  term = runTerm;
+                  found = true;
+                }
+            }
+        }
+      if (!found)
+        {
+          break;
+        }
+
+      // the term's docID blocks, merged the same way; the newest run decides a docID
+      std::vector<uint32_t> docCursors (runCount, 0);
+      std::vector<TermEntry const *> entries (runCount, NULL);
+      for (size_t r = 0; r < runCount; ++r)
+        {
+          if (termCursors[r] < runs[r].terms.size ()
+              && Compare (TermOf (runs[r], runs[r].terms[termCursors[r]]), term) == 0)
+            {
+              entries[r] = &runs[r].terms[termCursors[r]++];
+            }
+        }
+
+      docs.clear ();
+      while (true)
+        {
+          bool docFound = false;
+          Slice doc = { NULL, 0 };
+          bool present = false;
+          for (size_t r = 0; r < runCount; ++r)
+            {
+              if (entries[r] == NULL || docCursors[r] == entries[r]->docCount)
+                {
+                  continue;
+                }
+              Slice runDoc = DocOf (runs[r], runs[r].docs[entries[r]->firstDoc + docCursors[r]]);
+              if (!docFound || Compare (runDoc, doc) < 0)
+                {
+                  doc = runDoc;
+                  docFound = true;
+                }
+            }
+          if (!docFound)
+            {
+              break;
+            }
+          for (size_t r = 0; r < runCount; ++r)
+            {
+              if (entries[r] == NULL || docCursors[r] == entries[r]->docCount)
+                {
+                  continue;
+                }
+              DocEntry const &docEntry = runs[r].docs[entries[r]->firstDoc + docCursors[r]];
+              if (Compare (DocOf (runs[r], docEntry), doc) == 0)
+                {
+                  present = docEntry.present;
+                  ++docCursors[r];
+                }
+            }
+          // with the oldest run merged a removal has nothing left to shadow
+          if (present || first > 0)
+            {
+              docs.push_back (std::make_pair (doc, present));
+            }
+        }
+      // a spilled term goes from every run at once, or its older entries would outlive the newer
+      termString.assign (term.data, term.length);
+      if (!docs.empty () && (first > 0 || m_spilled.find (termString) == m_spilled.end ()))
+        {
+          Append (merged, term, docs);
+        }
+    }
+
+  m_runs.erase (m_runs.begin () + first + 1, m_runs.end ());
+  m_runs[first].terms.swap (merged.terms);
+  m_runs[first].docs.swap (merged.docs);
+  m_runs[first].pool.swap (merged.pool);
+}
+
+uint32_t
+PennTermStore::GetRunCount () const
+{
+  return m_runs.size ();
+}
+
+uint64_t
+PennTermStore::GetRunBytes () const
+{
+  uint64_t bytes = 0;
+  for (auto const &run : m_runs)
+    {
+      bytes += run.terms.size () * sizeof (TermEntry) + run.docs.size () * sizeof (DocEntry) + run.pool.size ();
+    }
+  return bytes;
+}
+
+uint64_t
+PennTermStore::GetMemoryBytes () const
+{
+  uint64_t bytes = m_bufferBytes + m_indexBytes;
+  for (auto const &run : m_runs)
+    {
+      bytes += RunBytes (run);
+    }
+  return bytes;
+}
+
+// what the last spill frees is only counted once its compaction ran
+bool
+PennTermStore::NeedsSpill () const
+{
+  return m_memoryBudget > 0 && !m_spillCompactionPending && GetMemoryBytes () > m_memoryBudget;
+}
+
+uint32_t
+PennTermStore::Spill ()
+{
+  if (m_memoryBudget == 0)
+    {
+      return 0;
+    }
+
+  // the whole store in runs, so a spilled term leaves no buffered entry behind; the owner runs the
+  // compaction that drops the spilled terms from the runs as its own task, like any other
+  Flush ();
+
+  std::vector<std::pair<uint64_t, std::string> > coldest;
+  for (auto const &ent : m_lastUse)
+    {
+      if (m_spilled.find (ent.first) == m_spilled.end ())
+        {
+          coldest.push_back (std::make_pair (ent.second, ent.first));
+        }
+    }
+  std::sort (coldest.begin (), coldest.end ());
+
+  uint64_t target = m_memoryBudget / 4 * 3;
+  uint64_t memory = GetMemoryBytes ();
+  uint32_t spilledCount = 0;
+  for (auto const &use : coldest)
+    {
+      if (memory <= target)
+        {
+          break;
+        }
+      std::string const &term = use.second;
+      std::set<std::string> docIDs;
+      if (!Merge (term, docIDs))
+        {
+          auto useFind = m_lastUse.find (term);
+          m_indexBytes -= MAP_NODE_BYTES + sizeof (*useFind) + StringBytes (useFind->first);
+          m_lastUse.erase (useFind);
+          continue;
+        }
+
+      // u32 doc count, then u32 length and bytes of each docID
+      std::string block;
+      uint32_t docCount = docIDs.size ();
+      uint64_t freed = sizeof (TermEntry) + term.length ();
+      block.append ((const char *) &docCount, sizeof (docCount));
+      for (auto const &doc : docIDs)
+        {
+          uint32_t docLength = doc.length ();
+          block.append ((const char *) &docLength, sizeof (docLength));
+          block += doc;
+          freed += sizeof (DocEntry) + docLength;
+        }
+      if (pwrite (m_segmentFd, block.data (), block.size (), m_segmentSize) != (ssize_t) block.size ())
+        {
+          break;
+        }
+
+      SpillEntry spillEntry = { m_segmentSize, (uint32_t) block.size () };
+      auto inserted = m_spilled.insert (std::make_pair (term, spillEntry));
+      m_indexBytes += MAP_NODE_BYTES + sizeof (*inserted.first) + StringBytes (inserted.first->first);
+      m_segmentSize += block.size ();
+      memory -= std::min (memory, freed);
+      ++spilledCount;
+    }
+
+  m_spillCompactionPending = spilledCount > 0;
+  return spilledCount;
+}
+
+uint32_t
+PennTermStore::GetSpilledCount () const
+{
+  return m_spilled.size ();
+}
+
+uint64_t
+PennTermStore::GetSegmentBytes () const
+{
+  return m_segmentSize;
+}
+
+bool
+PennTermStore::NeedsSegmentRewrite () const
+{
+  return m_segmentDeadBytes >= SEGMENT_REWRITE_MIN_BYTES && m_segmentDeadBytes * 2 > m_segmentSize;
+}
+
+void
+PennTermStore::RewriteSegment ()
+{
+  std::string tempName = m_segmentFile + ".tmp";
+  int fd = open (tempName.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      return;
+    }
+
+  // the new offsets are only taken once every block is copied, a failed rewrite leaves the old segment in use
+  std::vector<uint64_t> offsets;
+  uint64_t size = 0;
+  std::string block;
+  for (auto const &ent : m_spilled)
+    {
+      block.resize (ent.second.size);
+      if (pread (m_segmentFd, &block[0], block.size (), ent.second.offset) != (ssize_t) block.size ()
+          || pwrite (fd, block.data (), block.size (), size) != (ssize_t) block.size ())
+        {
+          close (fd);
+          remove (tempName.c_str ());
+          return;
+        }
+      offsets.push_back (size);
+      size += block.size ();
+    }
+  if (rename (tempName.c_str (), m_segmentFile.c_str ()) != 0)
+    {
+      close (fd);
+      remove (tempName.c_str ());
+      return;
+    }
+
+  size_t i = 0;
+  for (auto &ent : m_spilled)
+    {
+      ent.second.offset = offsets[i++];
+    }
+  close (m_segmentFd);
+  m_segmentFd = fd;
+  m_segmentSize = size;
+  m_segmentDeadBytes = 0;
+}
+
+bool
+PennTermStore::ReadSpilled (SpillEntry const &spillEntry, std::set<std::string> &docIDs) const
+{
+  docIDs.clear ();
+  std::string block (spillEntry.size, '\0');
+  if (pread (m_segmentFd, &block[0], block.size (), spillEntry.offset) != (ssize_t) block.size ())
+    {
+      return false;
+    }
+
+  uint32_t docCount;
+  size_t position = 0;
+  memcpy (&docCount, block.data (), sizeof (docCount));
+  position += sizeof (docCount);
+  for (uint32_t i = 0; i < docCount; ++i)
+    {
+      uint32_t docLength;
+      memcpy (&docLength, block.data () + position, sizeof (docLength));
+      position += sizeof (docLength);
+      docIDs.insert (docIDs.end (), block.substr (position, docLength));
+      position += docLength;
+    }
+  return !docIDs.empty ();
+}
+
+void
+PennTermStore::FaultIn (std::string const &term)
+{
+  auto spillFind = m_spilled.find (term);
+  if (spillFind == m_spilled.end ())
+    {
+      return;
+    }
+
+  std::set<std::string> docIDs;
+  ReadSpilled (spillFind->second, docIDs);
+  m_segmentDeadBytes += spillFind->second.size;
+  m_indexBytes -= MAP_NODE_BYTES + sizeof (*spillFind) + StringBytes (spillFind->first);
+  m_spilled.erase (spillFind);
+  // the runs hold nothing of a spilled term, its docIDs go back as buffered adds
+  for (auto const &doc : docIDs)
+    {
+      auto inserted = m_buffer.insert (std::make_pair (std::make_pair (term, doc), true));
+      m_bufferBytes += MAP_NODE_BYTES + sizeof (*inserted.first) + StringBytes (inserted.first->first.first)
+                       + StringBytes (inserted.first->first.second);
+    }
+
+  // the space of faulted in lists is taken back once nothing is spilled
+  if (m_spilled.empty () && ftruncate (m_segmentFd, 0) == 0)
+    {
+      m_segmentSize = 0;
+      m_segmentDeadBytes = 0;
+    }
+}
+
+void
+PennTermStore::Touch (std::string const &term)
+{
+  if (m_memoryBudget == 0)
+    {
+      return;
+    }
+  auto inserted = m_lastUse.insert (std::make_pair (term, (uint64_t) 0));
+  if (inserted.second)
+    {
+      m_indexBytes += MAP_NODE_BYTES + sizeof (*inserted.first) + StringBytes (inserted.first->first);
+    }
+  inserted.first->second = ++m_tick;
+}
+
+PennTermStore::Slice
+PennTermStore::TermOf (Run const &run, TermEntry const &termEntry)
+{
+  Slice term = { run.pool.data () + termEntry.termOffset, termEntry.termLength };
+  return term;
+}
+
+PennTermStore::Slice
+PennTermStore::DocOf (Run const &run, DocEntry const &docEntry)
+{
+  Slice doc = { run.pool.data () + docEntry.docOffset, docEntry.docLength };
+  return doc;
+}
+
+PennTermStore::Slice
+PennTermStore::SliceOf (std::string const &s)
+{
+  Slice slice = { s.data (), (uint32_t) s.length () };
+  return slice;
+}
+
+// the order of std::string::compare
+int
+PennTermStore::Compare (Slice const &a, Slice const &b)
+{
+  int result = memcmp (a.data, b.data, std::min (a.length, b.length));
+  if (result != 0)
+    {
+      return result;
+    }
+  return (a.length < b.length) ? -1 : (a.length > b.length);
+}
+
+uint32_t
+PennTermStore::Find (Run const &run, std::string const &term)
+{
+  auto termIter = std::lower_bound (run.terms.begin (), run.terms.end (), term,
+                                    [&run] (TermEntry const &termEntry, std::string const &t) {
+                                      return run.pool.compare (termEntry.termOffset, termEntry.termLength, t) < 0;
+                                    });
+  if (termIter == run.terms.end ()
+      || run.pool.compare (termIter->termOffset, termIter->termLength, term) != 0)
+    {
+      return run.terms.size ();
+    }
+  return termIter - run.terms.begin ();
+}
+
+void
+PennTermStore::Append (Run &run, Slice const &term, std::vector<std::pair<Slice, bool> > const &docs)
+{
+  TermEntry termEntry;
+  termEntry.termOffset = run.pool.size ();
+  termEntry.termLength = term.length;
+  termEntry.firstDoc = run.docs.size ();
+  termEntry.docCount = docs.size ();
+  run.pool.append (term.data, term.length);
+  run.terms.push_back (termEntry);
+
+  for (auto const &doc : docs)
+    {
+      DocEntry docEntry;
+      docEntry.docOffset = run.pool.size ();
+      docEntry.docLength = doc.first.length;
+      docEntry.present = doc.second;
+      run.pool.append (doc.first.data, doc.first.length);
+      run.docs.push_back (docEntry);
+    }
+}
+
+uint64_t
+PennTermStore::StringBytes (std::string const &s)
+{
+  // a short string lives inside the object itself
+  const char *inside = (const char *) &s;
+  if (s.data () >= inside && s.data () < inside + sizeof (s))
+    {
+      return 0;
+    }
+  return s.capacity () + 1;
+}
+
+uint64_t
+PennTermStore::RunBytes (Run const &run)
+{
+  return sizeof (Run) + run.terms.capacity () * sizeof (TermEntry) + run.docs.capacity () * sizeof (DocEntry)
+         + StringBytes (run.pool);
+}
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_TERM_STORE_H
+#define PENN_TERM_STORE_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Log-structured store of a node's posting lists.
+ *
+ * Writes go to a small sorted buffer of <term, docID> -> present/removed entries. A full buffer
+ * is flushed to an immutable sorted run, laid out like the index snapshot: a term dictionary,
+ * contiguous docID blocks and one string pool, so a run is a handful of allocations whatever it
+ * holds. A read walks the runs and the buffer side by side in docID order, the newest entry of a
+ * docID wins. Compaction merges the newest runs into one, going further back while the next older
+ * run is no larger than the merge so far, and drops the removed entries once the oldest run is
+ * part of it; the owner runs it as its own task once NeedsCompaction () says so.
+ *
+ * With a memory budget the store counts the heap bytes it holds. Over budget, Spill () writes the
+ * least recently used posting lists to a scratch segment file, down to three quarters of the
+ * budget, and the next compaction merges all runs to take them out of memory. A spilled term is
+ * read back into the buffer on its next Get, Add or Remove; GetAll reads spilled terms in place.
+ * The blocks of read back terms are dead space in the segment, which compaction rewrites once
+ * they are most of it.
+ */
+class PennTermStore
+{
+public:
+  PennTermStore ();
+  ~PennTermStore ();
+
+  /**
+   *  \param bufferSize buffered entries at which NeedsFlush () turns true
+   *  \param maxRuns runs above which NeedsCompaction () turns true
+   */
+  void SetLimits (uint32_t bufferSize, uint32_t maxRuns);
+
+  /**
+   *  \brief Bounds the memory held, spilling to segmentFile (recreated empty)
+   *  \returns false if the segment file could not be created
+   */
+  bool SetMemoryBudget (uint64_t budget, std::string const &segmentFile);
+
+  void Add (std::string const &term, std::string const &doc);
+  void Remove (std::string const &term, std::string const &doc);
+
+  /**
+   *  \brief Copies the docIDs of term into docIDs
+   *  \returns false if the term has no docIDs
+   */
+  bool Get (std::string const &term, std::set<std::string> &docIDs);
+  bool Contains (std::string const &term) const;
+  bool Contains (std::string const &term, std::string const &doc);
+  uint32_t Count (std::string const &term);
+
+  /**
+   *  \brief Copies the lowest docID of term not below from into doc
+   *  \returns false if there is none
+   */
+  bool LowerBound (std::string const &term, std::string const &from, std::string &doc);
+
+  /**
+   *  \brief Copies every term with its docIDs into termStore
+   */
+  void GetAll (std::map<std::string, std::set<std::string> > &termStore) const;
+
+  bool NeedsFlush () const;
+  void Flush ();
+  bool NeedsCompaction () const;
+  void Compact ();
+
+  uint32_t GetRunCount () const;
+  uint64_t GetRunBytes () const;
+
+  /**
+   *  \returns heap and node bytes of the buffer, the runs and the bookkeeping of each term
+   */
+  uint64_t GetMemoryBytes () const;
+  bool NeedsSpill () const;
+  /**
+   *  \returns the number of posting lists spilled
+   */
+  uint32_t Spill ();
+  uint32_t GetSpilledCount () const;
+  uint64_t GetSegmentBytes () const;
+
+private:
+  struct TermEntry
+  {
+    uint32_t termOffset;
+    uint32_t termLength;
+    uint32_t firstDoc;
+    uint32_t docCount;
+  };
+
+  struct DocEntry
+  {
+    uint32_t docOffset;
+    uint32_t docLength;
+    bool present; // false: a removal that shadows the docID in older runs
+  };
+
+  // where a spilled posting list lives in the segment file
+  struct SpillEntry
+  {
+    uint64_t offset;
+    uint32_t size;
+  };
+
+  struct Run
+  {
+    std::vector<TermEntry> terms; // sorted by term
+    std::vector<DocEntry> docs;   // each term's block sorted by docID
+    std::string pool;
+  };
+
+  // a term or docID where it lies, in a run's pool or a buffered key
+  struct Slice
+  {
+    const char *data;
+    uint32_t length;
+  };
+
+  static Slice TermOf (Run const &run, TermEntry const &termEntry);
+  static Slice DocOf (Run const &run, DocEntry const &docEntry);
+  static Slice SliceOf (std::string const &s);
+  static int Compare (Slice const &a, Slice const &b);
+  static uint32_t Find (Run const &run, std::string const &term);
+  static void Append (Run &run, Slice const &term, std::vector<std::pair<Slice, bool> > const &docs);
+  static uint64_t StringBytes (std::string const &s);
+  static uint64_t RunBytes (Run const &run);
+
+  // the present docIDs of term not below from in order, until visit returns false; spilled terms have none
+  void Walk (std::string const &term, std::string const &from, std::function<bool (Slice const &)> const &visit) const;
+  // the docIDs of term in the buffer and the runs, spilled or not
+  bool Merge (std::string const &term, std::set<std::string> &docIDs) const;
+  // merges the runs from first on into one
+  void CompactFrom (size_t first);
+  bool NeedsSegmentRewrite () const;
+  // copies the live blocks to a fresh segment file
+  void RewriteSegment ();
+  bool ReadSpilled (SpillEntry const &spillEntry, std::set<std::string> &docIDs) const;
+  void FaultIn (std::string const &term);
+  void Touch (std::string const &term);
+
+  uint32_t m_bufferSize;
+  uint32_t m_maxRuns;
+  // <term, docID> -> present
+  std::map<std::pair<std::string, std::string>, bool> m_buffer;
+  uint64_t m_bufferBytes;
+  // the spill index and the use ticks
+  uint64_t m_indexBytes;
+  // oldest first
+  std::vector<Run> m_runs;
+
+  uint64_t m_memoryBudget; // 0: unbounded
+  std::string m_segmentFile;
+  int m_segmentFd;
+  uint64_t m_segmentSize;
+  // bytes of blocks read back since the segment was last written from scratch
+  uint64_t m_segmentDeadBytes;
+  // spilled terms; their entries still in the runs are stale and go at the next compaction, which
+  // has to merge every run then
+  std::map<std::string, SpillEntry> m_spilled;
+  bool m_spillCompactionPending;
+  // term -> tick of its last use, the lowest ticks are spilled first
+  std::map<std::string, uint64_t> m_lastUse;
+  uint64_t m_tick;
+};
+
+#endif
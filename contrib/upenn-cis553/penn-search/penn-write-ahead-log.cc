@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "penn-write-ahead-log.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+PennWriteAheadLog::PennWriteAheadLog ()
+  : m_fd (-1),
+    m_pendingCount (0)
+{
+}
+
+PennWriteAheadLog::~PennWriteAheadLog ()
+{
+  Close ();
+}
+
+bool
+PennWriteAheadLog::Open (std::string const &fileName, std::vector<Record> &records)
+{
+  Close ();
+  records.clear ();
+
+  std::string contents;
+  std::ifstream in (fileName.c_str (), std::ios::binary);
+  if (in)
+    {
+      contents.assign (std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char> ());
+    }
+
+  // every record whole and matching its checksum, up to the first one that isn't
+  size_t position = 0;
+  size_t validSize = 0;
+  while (true)
+    {
+      size_t start = position;
+      uint32_t termLength, docLength, checksum;
+      if (contents.size () - position < 1 + sizeof (termLength))
+        {
+          break;
+        }
+      bool present = contents[position++] != 0;
+      memcpy (&termLength, contents.data () + position, sizeof (termLength));
+      position += sizeof (termLength);
+      if (contents.size () - position < (size_t) termLength + sizeof (docLength))
+        {
+          break;
+        }
+      std::string term = contents.substr (position, termLength);
+      position += termLength;
+      memcpy (&docLength, contents.data () + position, sizeof (docLength));
+      position += sizeof (docLength);
+      if (contents.size () - position < (size_t) docLength + sizeof (checksum))
+        {
+          break;
+        }
+      std::string doc = contents.substr (position, docLength);
+      position += docLength;
+      memcpy (&checksum, contents.data () + position, sizeof (checksum));
+      if (checksum != Checksum (contents.data () + start, position - start))
+        {
+          break;
+        }
+      position += sizeof (checksum);
+
+      Record record = { present, term, doc };
+      records.push_back (record);
+      validSize = position;
+    }
+
+  m_fd = open (fileName.c_str (), O_WRONLY | O_CREAT, 0644);
+  if (m_fd < 0)
+    {
+      records.clear ();
+      return false;
+    }
+  if (ftruncate (m_fd, validSize) != 0 || lseek (m_fd, validSize, SEEK_SET) < 0)
+    {
+      Close ();
+      records.clear ();
+      return false;
+    }
+  return true;
+}
+
+void
+PennWriteAheadLog::Close ()
+{
+  if (m_fd >= 0)
+    {
+      close (m_fd);
+    }
+  m_fd = -1;
+  m_pending.clear ();
+  m_pendingCount = 0;
+}
+
+bool
+PennWriteAheadLog::IsOpen () const
+{
+  return m_fd >= 0;
+}
+
+void
+PennWriteAheadLog::Append (bool present, std::string const &term, std::string const &doc)
+{
+  size_t start = m_pending.size ();
+  uint32_t termLength = term.length ();
+  uint32_t docLength = doc.length ();
+  m_pending.push_back (present ? 1 : 0);
+  m_pending.append ((const char *) &termLength, sizeof (termLength));
+  m_pending += term;
+  m_pending.append ((const char *) &docLength, sizeof (docLength));
+  m_pending += doc;
+  uint32_t checksum = Checksum (m_pending.data () + start, m_pending.size () - start);
+  m_pending.append ((const char *) &checksum, sizeof (checksum));
+  ++m_pendingCount;
+}
+
+uint32_t
+PennWriteAheadLog::GetPendingCount () const
+{
+  return m_pendingCount;
+}
+
+bool
+PennWriteAheadLog::Commit ()
+{
+  if (m_fd < 0 || m_pending.empty ())
+    {
+      return m_fd >= 0;
+    }
+
+  size_t written = 0;
+  while (written < m_pending.size ())
+    {
+      ssize_t count = write (m_fd, m_pending.data () + written, m_pending.size () - written);
+      if (count < 0)
+        {
+          // cut what got out, the whole group is written again next time
+          off_t end = lseek (m_fd, 0, SEEK_CUR) - written;
+          if (ftruncate (m_fd, end) == 0)
+            {
+              lseek (m_fd, end, SEEK_SET);
+            }
+          return false;
+        }
+      written += count;
+    }
+  if (fsync (m_fd) != 0)
+    {
+      return false;
+    }
+
+  m_pending.clear ();
+  m_pendingCount = 0;
+  return true;
+}
+
+bool
+PennWriteAheadLog::Truncate ()
+{
+  m_pending.clear ();
+  m_pendingCount = 0;
+  if (m_fd < 0)
+    {
+      return false;
+    }
+  return ftruncate (m_fd, 0) == 0 && lseek (m_fd, 0, SEEK_SET) == 0 && fsync (m_fd) == 0;
+}
+
+uint32_t
+PennWriteAheadLog::Checksum (const char *data, size_t size)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i)
+    {
+      hash = (hash ^ (uint8_t) data[i]) * 16777619u;
+    }
+  return hash;
+}
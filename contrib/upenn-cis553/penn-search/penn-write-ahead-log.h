@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PENN_WRITE_AHEAD_LOG_H
+#define PENN_WRITE_AHEAD_LOG_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * Append-only log of a node's term store writes, replayed over its snapshot at restart.
+ *
+ * Record (host byte order, like the snapshot the file stays on the node that wrote it):
+ *   op        1 byte, 1 add / 0 remove
+ *   term      u32 length, bytes
+ *   doc       u32 length, bytes
+ *   checksum  u32 FNV-1a of the fields above
+ * Appends are buffered and written by Commit () with one fsync for the whole group. A crash
+ * loses at most the uncommitted group; a record torn by it fails its checksum and the log is
+ * cut there when it is opened again.
+ */
+class PennWriteAheadLog
+{
+public:
+  struct Record
+  {
+    bool present;
+    std::string term;
+    std::string doc;
+  };
+
+  PennWriteAheadLog ();
+  ~PennWriteAheadLog ();
+
+  /**
+   *  \brief Reads the records of fileName, cuts any torn tail and opens it for appending
+   *  \param records the records found, oldest first
+   *  \returns false if the file could not be opened
+   */
+  bool Open (std::string const &fileName, std::vector<Record> &records);
+  void Close ();
+  bool IsOpen () const;
+
+  void Append (bool present, std::string const &term, std::string const &doc);
+  uint32_t GetPendingCount () const;
+
+  /**
+   *  \brief Writes the pending records and syncs the file
+   *  \returns false if the write or the sync failed, the records stay pending then
+   */
+  bool Commit ();
+
+  /**
+   *  \brief Empties the log, pending records included, once a snapshot holds all of it
+   */
+  bool Truncate ();
+
+private:
+  static uint32_t Checksum (const char *data, size_t size);
+
+  int m_fd;
+  std::string m_pending;
+  uint32_t m_pendingCount;
+};
+
+#endif